@@ -0,0 +1,194 @@
+#version 450
+
+// gpu counterpart of create_gears() in sdlgpu_gear_creation.c, which stays the reference (see -verify_mesh_gen)
+// one thread per tooth writes that tooth's share of the raw (unwelded) mesh, in exactly the cpu generator's layout
+
+layout(local_size_x = 64, local_size_y = 1, local_size_z = 1) in;
+
+// GpuGearParams in sdlgpu_gear_compute.c, one per workgroup row
+struct GearShape {
+    vec4 shape; // inner_radius, outer_radius, width, tooth_depth
+    uint teeth;
+    uint first_vertex; // where the mesh starts in the pool
+    uint first_index;
+    uint padding;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer Params {
+    GearShape gears[];
+};
+
+// Vertex/CompactVertex and 16/32-bit indices, written as 32-bit words
+layout(std430, set = 1, binding = 0) writeonly buffer Vertices {
+    uint vertex_words[];
+};
+
+layout(std430, set = 1, binding = 1) writeonly buffer Indices {
+    uint index_words[];
+};
+
+layout(set = 2, binding = 0) uniform UniformBuffer {
+    uint compact_vertices; // VERTEX_COMPACT, VERTEX_FULL otherwise
+    uint short_indices;    // 16-bit indices, every quad starts at an even index so they're written in pairs
+} ubo;
+
+const float PI = 3.14159265358979323846;
+
+uint first_vertex;
+uint first_index;
+
+vec2 polar(float r, float angle) {
+    return r * vec2(cos(angle), sin(angle));
+}
+
+// outward normal of the tooth side from a to b (counterclockwise around the gear)
+vec3 side_normal(vec2 a, vec2 b) {
+    vec2 edge = b - a;
+    return vec3(normalize(vec2(edge.y, -edge.x)), 0.0);
+}
+
+// same encoding as compact_vertex() on the cpu
+vec2 oct_encode(vec3 n) {
+    vec2 o = n.xy / (abs(n.x) + abs(n.y) + abs(n.z));
+    if (n.z < 0.0)
+        o = (1.0 - abs(o.yx)) * vec2(o.x >= 0.0 ? 1.0 : -1.0, o.y >= 0.0 ? 1.0 : -1.0);
+    return o;
+}
+
+// v is relative to the mesh, like the indices
+void put_vertex(uint v, vec2 xy, float z, vec3 normal) {
+    uint at = first_vertex + v;
+    if (ubo.compact_vertices != 0u) {
+        at *= 3u;
+        vertex_words[at + 0u] = packHalf2x16(xy);
+        vertex_words[at + 1u] = packHalf2x16(vec2(z, 1.0));
+        vertex_words[at + 2u] = packSnorm2x16(oct_encode(normal));
+    } else {
+        at *= 6u;
+        vertex_words[at + 0u] = floatBitsToUint(xy.x);
+        vertex_words[at + 1u] = floatBitsToUint(xy.y);
+        vertex_words[at + 2u] = floatBitsToUint(z);
+        vertex_words[at + 3u] = floatBitsToUint(normal.x);
+        vertex_words[at + 4u] = floatBitsToUint(normal.y);
+        vertex_words[at + 5u] = floatBitsToUint(normal.z);
+    }
+}
+
+// the two triangles of a quad, i is relative to the mesh's first index
+void put_quad(uint i, uint a, uint b, uint c, uint d, uint e, uint f) {
+    uint at = first_index + i;
+    if (ubo.short_indices != 0u) {
+        at /= 2u;
+        index_words[at + 0u] = a | (b << 16);
+        index_words[at + 1u] = c | (d << 16);
+        index_words[at + 2u] = e | (f << 16);
+    } else {
+        index_words[at + 0u] = a;
+        index_words[at + 1u] = b;
+        index_words[at + 2u] = c;
+        index_words[at + 3u] = d;
+        index_words[at + 4u] = e;
+        index_words[at + 5u] = f;
+    }
+}
+
+void main() {
+    GearShape gear = gears[gl_WorkGroupID.y];
+    uint t = gear.teeth;
+    uint i = gl_GlobalInvocationID.x;
+    if (i >= t)
+        return;
+
+    first_vertex = gear.first_vertex;
+    first_index = gear.first_index;
+
+    float r0 = gear.shape.x;
+    float r1 = gear.shape.y - gear.shape.w * 0.5;
+    float r2 = gear.shape.y + gear.shape.w * 0.5;
+    float half_width = gear.shape.z * 0.5;
+    float tooth_angle = 2.0 * PI / float(t);
+    float da = tooth_angle / 4.0;
+
+    float angle = float(i) * tooth_angle;
+    float next_angle = float(i + 1u) * tooth_angle;
+    bool last = (i == t - 1u);
+
+    // section offsets in the raw mesh, see gear_vertex_count()/gear_index_count()
+    uint ring_vertex[2] = uint[](0u, 8u * t + 2u);
+    uint ring_index[2] = uint[](0u, 18u * t);
+    uint tooth_vertex[2] = uint[](4u * t + 2u, 12u * t + 4u);
+    uint tooth_index[2] = uint[](12u * t, 30u * t);
+    uint strip_vertex = 16u * t + 4u;
+    uint strip_index = 36u * t;
+    uint cylinder_vertex = 24u * t + 6u;
+    uint cylinder_index = 60u * t;
+
+    for (uint side = 0u; side < 2u; side++) {
+        float z = side == 0u ? half_width : -half_width;
+        vec3 normal = vec3(0.0, 0.0, side == 0u ? 1.0 : -1.0);
+
+        // main ring strip, 4 vertices per tooth (the last tooth also closes it) and 2 quads
+        uint rv = ring_vertex[side];
+        put_vertex(rv + 4u * i + 0u, polar(r0, angle), z, normal);
+        put_vertex(rv + 4u * i + 1u, polar(r1, angle), z, normal);
+        put_vertex(rv + 4u * i + 2u, polar(r0, angle), z, normal);
+        put_vertex(rv + 4u * i + 3u, polar(r1, angle + 3.0 * da), z, normal);
+        if (last) {
+            put_vertex(rv + 4u * t + 0u, polar(r0, next_angle), z, normal);
+            put_vertex(rv + 4u * t + 1u, polar(r1, next_angle), z, normal);
+        }
+        for (uint q = 2u * i; q < 2u * i + 2u; q++) {
+            uint v0 = rv + 2u * q;
+            if (side == 0u)
+                put_quad(ring_index[0] + 6u * q, v0, v0 + 1u, v0 + 3u, v0, v0 + 3u, v0 + 2u);
+            else
+                put_quad(ring_index[1] + 6u * q, v0, v0 + 3u, v0 + 1u, v0, v0 + 2u, v0 + 3u);
+        }
+
+        // tooth top, a single quad
+        uint tv = tooth_vertex[side] + 4u * i;
+        put_vertex(tv + 0u, polar(r1, angle), z, normal);
+        put_vertex(tv + 1u, polar(r2, angle + da), z, normal);
+        put_vertex(tv + 2u, polar(r2, angle + 2.0 * da), z, normal);
+        put_vertex(tv + 3u, polar(r1, angle + 3.0 * da), z, normal);
+        if (side == 0u)
+            put_quad(tooth_index[0] + 6u * i, tv, tv + 1u, tv + 2u, tv, tv + 2u, tv + 3u);
+        else
+            put_quad(tooth_index[1] + 6u * i, tv, tv + 2u, tv + 1u, tv, tv + 3u, tv + 2u);
+    }
+
+    // outer strip, front/back pairs at +0da, +1da, +2da, +3da (the last tooth also closes it at angle 0) and 4 quads
+    vec2 radial = vec2(cos(angle), sin(angle));
+    vec2 p1 = polar(r2, angle + da);
+    vec2 p2 = polar(r2, angle + 2.0 * da);
+    vec2 p3 = polar(r1, angle + 3.0 * da);
+    vec3 slant1 = side_normal(r1 * radial, p1);
+    vec3 slant2 = side_normal(p2, p3);
+
+    uint sv = strip_vertex + 8u * i;
+    put_vertex(sv + 0u, r1 * radial, half_width, vec3(radial, 0.0));
+    put_vertex(sv + 1u, r1 * radial, -half_width, vec3(radial, 0.0));
+    put_vertex(sv + 2u, p1, half_width, slant1);
+    put_vertex(sv + 3u, p1, -half_width, slant1);
+    put_vertex(sv + 4u, p2, half_width, vec3(radial, 0.0));
+    put_vertex(sv + 5u, p2, -half_width, vec3(radial, 0.0));
+    put_vertex(sv + 6u, p3, half_width, slant2);
+    put_vertex(sv + 7u, p3, -half_width, slant2);
+    if (last) {
+        put_vertex(strip_vertex + 8u * t + 0u, vec2(r1, 0.0), half_width, vec3(1.0, 0.0, 0.0));
+        put_vertex(strip_vertex + 8u * t + 1u, vec2(r1, 0.0), -half_width, vec3(1.0, 0.0, 0.0));
+    }
+    for (uint q = 4u * i; q < 4u * i + 4u; q++) {
+        uint v0 = strip_vertex + 2u * q;
+        put_quad(strip_index + 6u * q, v0, v0 + 1u, v0 + 3u, v0, v0 + 3u, v0 + 2u);
+    }
+
+    // inner cylinder, normals pointing inward (toward axis)
+    vec2 next_radial = vec2(cos(next_angle), sin(next_angle));
+    uint cv = cylinder_vertex + 4u * i;
+    put_vertex(cv + 0u, r0 * radial, -half_width, vec3(-radial, 0.0));
+    put_vertex(cv + 1u, r0 * radial, half_width, vec3(-radial, 0.0));
+    put_vertex(cv + 2u, r0 * next_radial, half_width, vec3(-next_radial, 0.0));
+    put_vertex(cv + 3u, r0 * next_radial, -half_width, vec3(-next_radial, 0.0));
+    put_quad(cylinder_index + 6u * i, cv, cv + 1u, cv + 2u, cv, cv + 2u, cv + 3u);
+}
@@ -0,0 +1,178 @@
+// gpu counterpart of create_gears() in sdlgpu_gear_creation.c, which stays the reference (see -verify_mesh_gen)
+// one thread per tooth writes that tooth's share of the raw (unwelded) mesh, in exactly the cpu generator's layout
+
+// GpuGearParams in sdlgpu_gear_compute.c, one per workgroup row
+struct GearShape {
+    float4 shape; // inner_radius, outer_radius, width, tooth_depth
+    uint teeth;
+    uint first_vertex; // where the mesh starts in the pool
+    uint first_index;
+    uint padding;
+};
+
+StructuredBuffer<GearShape> gears : register(t0, space0);
+
+// Vertex/CompactVertex and 16/32-bit indices, written as 32-bit words
+RWByteAddressBuffer vertex_words : register(u0, space1);
+RWByteAddressBuffer index_words : register(u1, space1);
+
+cbuffer UniformBuffer : register(b0, space2) {
+    uint compact_vertices; // VERTEX_COMPACT, VERTEX_FULL otherwise
+    uint short_indices;    // 16-bit indices, every quad starts at an even index so they're written in pairs
+};
+
+static const float PI = 3.14159265358979323846;
+
+static uint first_vertex;
+static uint first_index;
+
+float2 polar(float r, float angle) {
+    return r * float2(cos(angle), sin(angle));
+}
+
+// outward normal of the tooth side from a to b (counterclockwise around the gear)
+float3 side_normal(float2 a, float2 b) {
+    float2 edge = b - a;
+    return float3(normalize(float2(edge.y, -edge.x)), 0.0);
+}
+
+// same encoding as compact_vertex() on the cpu
+float2 oct_encode(float3 n) {
+    float2 o = n.xy / (abs(n.x) + abs(n.y) + abs(n.z));
+    if (n.z < 0.0)
+        o = (1.0 - abs(o.yx)) * float2(o.x >= 0.0 ? 1.0 : -1.0, o.y >= 0.0 ? 1.0 : -1.0);
+    return o;
+}
+
+uint pack_half2(float2 v) {
+    return f32tof16(v.x) | (f32tof16(v.y) << 16);
+}
+
+uint pack_snorm2(float2 v) {
+    int2 s = int2(round(clamp(v, -1.0, 1.0) * 32767.0));
+    return (uint(s.x) & 0xffff) | (uint(s.y) << 16);
+}
+
+// v is relative to the mesh, like the indices
+void put_vertex(uint v, float2 xy, float z, float3 normal) {
+    uint at = first_vertex + v;
+    if (compact_vertices != 0) {
+        vertex_words.Store3(at * 12, uint3(pack_half2(xy), pack_half2(float2(z, 1.0)), pack_snorm2(oct_encode(normal))));
+    } else {
+        vertex_words.Store3(at * 24, asuint(float3(xy, z)));
+        vertex_words.Store3(at * 24 + 12, asuint(normal));
+    }
+}
+
+// the two triangles of a quad, i is relative to the mesh's first index
+void put_quad(uint i, uint a, uint b, uint c, uint d, uint e, uint f) {
+    uint at = first_index + i;
+    if (short_indices != 0) {
+        index_words.Store3(at * 2, uint3(a | (b << 16), c | (d << 16), e | (f << 16)));
+    } else {
+        index_words.Store3(at * 4, uint3(a, b, c));
+        index_words.Store3(at * 4 + 12, uint3(d, e, f));
+    }
+}
+
+[numthreads(64, 1, 1)]
+void main(uint3 group_id : SV_GroupID, uint3 thread_id : SV_DispatchThreadID) {
+    GearShape gear = gears[group_id.y];
+    uint t = gear.teeth;
+    uint i = thread_id.x;
+    if (i >= t)
+        return;
+
+    first_vertex = gear.first_vertex;
+    first_index = gear.first_index;
+
+    float r0 = gear.shape.x;
+    float r1 = gear.shape.y - gear.shape.w * 0.5;
+    float r2 = gear.shape.y + gear.shape.w * 0.5;
+    float half_width = gear.shape.z * 0.5;
+    float tooth_angle = 2.0 * PI / float(t);
+    float da = tooth_angle / 4.0;
+
+    float angle = float(i) * tooth_angle;
+    float next_angle = float(i + 1) * tooth_angle;
+    bool last = (i == t - 1);
+
+    // section offsets in the raw mesh, see gear_vertex_count()/gear_index_count()
+    uint ring_vertex[2] = {0, 8 * t + 2};
+    uint ring_index[2] = {0, 18 * t};
+    uint tooth_vertex[2] = {4 * t + 2, 12 * t + 4};
+    uint tooth_index[2] = {12 * t, 30 * t};
+    uint strip_vertex = 16 * t + 4;
+    uint strip_index = 36 * t;
+    uint cylinder_vertex = 24 * t + 6;
+    uint cylinder_index = 60 * t;
+
+    for (uint side = 0; side < 2; side++) {
+        float z = side == 0 ? half_width : -half_width;
+        float3 normal = float3(0.0, 0.0, side == 0 ? 1.0 : -1.0);
+
+        // main ring strip, 4 vertices per tooth (the last tooth also closes it) and 2 quads
+        uint rv = ring_vertex[side];
+        put_vertex(rv + 4 * i + 0, polar(r0, angle), z, normal);
+        put_vertex(rv + 4 * i + 1, polar(r1, angle), z, normal);
+        put_vertex(rv + 4 * i + 2, polar(r0, angle), z, normal);
+        put_vertex(rv + 4 * i + 3, polar(r1, angle + 3.0 * da), z, normal);
+        if (last) {
+            put_vertex(rv + 4 * t + 0, polar(r0, next_angle), z, normal);
+            put_vertex(rv + 4 * t + 1, polar(r1, next_angle), z, normal);
+        }
+        for (uint q = 2 * i; q < 2 * i + 2; q++) {
+            uint v0 = rv + 2 * q;
+            if (side == 0)
+                put_quad(ring_index[0] + 6 * q, v0, v0 + 1, v0 + 3, v0, v0 + 3, v0 + 2);
+            else
+                put_quad(ring_index[1] + 6 * q, v0, v0 + 3, v0 + 1, v0, v0 + 2, v0 + 3);
+        }
+
+        // tooth top, a single quad
+        uint tv = tooth_vertex[side] + 4 * i;
+        put_vertex(tv + 0, polar(r1, angle), z, normal);
+        put_vertex(tv + 1, polar(r2, angle + da), z, normal);
+        put_vertex(tv + 2, polar(r2, angle + 2.0 * da), z, normal);
+        put_vertex(tv + 3, polar(r1, angle + 3.0 * da), z, normal);
+        if (side == 0)
+            put_quad(tooth_index[0] + 6 * i, tv, tv + 1, tv + 2, tv, tv + 2, tv + 3);
+        else
+            put_quad(tooth_index[1] + 6 * i, tv, tv + 2, tv + 1, tv, tv + 3, tv + 2);
+    }
+
+    // outer strip, front/back pairs at +0da, +1da, +2da, +3da (the last tooth also closes it at angle 0) and 4 quads
+    float2 radial = float2(cos(angle), sin(angle));
+    float2 p1 = polar(r2, angle + da);
+    float2 p2 = polar(r2, angle + 2.0 * da);
+    float2 p3 = polar(r1, angle + 3.0 * da);
+    float3 slant1 = side_normal(r1 * radial, p1);
+    float3 slant2 = side_normal(p2, p3);
+
+    uint sv = strip_vertex + 8 * i;
+    put_vertex(sv + 0, r1 * radial, half_width, float3(radial, 0.0));
+    put_vertex(sv + 1, r1 * radial, -half_width, float3(radial, 0.0));
+    put_vertex(sv + 2, p1, half_width, slant1);
+    put_vertex(sv + 3, p1, -half_width, slant1);
+    put_vertex(sv + 4, p2, half_width, float3(radial, 0.0));
+    put_vertex(sv + 5, p2, -half_width, float3(radial, 0.0));
+    put_vertex(sv + 6, p3, half_width, slant2);
+    put_vertex(sv + 7, p3, -half_width, slant2);
+    if (last) {
+        put_vertex(strip_vertex + 8 * t + 0, float2(r1, 0.0), half_width, float3(1.0, 0.0, 0.0));
+        put_vertex(strip_vertex + 8 * t + 1, float2(r1, 0.0), -half_width, float3(1.0, 0.0, 0.0));
+    }
+    for (uint q = 4 * i; q < 4 * i + 4; q++) {
+        uint v0 = strip_vertex + 2 * q;
+        put_quad(strip_index + 6 * q, v0, v0 + 1, v0 + 3, v0, v0 + 3, v0 + 2);
+    }
+
+    // inner cylinder, normals pointing inward (toward axis)
+    float2 next_radial = float2(cos(next_angle), sin(next_angle));
+    uint cv = cylinder_vertex + 4 * i;
+    put_vertex(cv + 0, r0 * radial, -half_width, float3(-radial, 0.0));
+    put_vertex(cv + 1, r0 * radial, half_width, float3(-radial, 0.0));
+    put_vertex(cv + 2, r0 * next_radial, half_width, float3(-next_radial, 0.0));
+    put_vertex(cv + 3, r0 * next_radial, -half_width, float3(-next_radial, 0.0));
+    put_quad(cylinder_index + 6 * i, cv, cv + 1, cv + 2, cv, cv + 2, cv + 3);
+}
@@ -0,0 +1,80 @@
+#version 450
+
+// frustum culling for RENDER_INDIRECT, one thread per gear
+// every gear that survives is copied into its mesh's run of the visible instance buffer and counted in that mesh's indirect draw
+
+layout(local_size_x = 64, local_size_y = 1, local_size_z = 1) in;
+
+// InstanceData in sdlgpu_render.h, as uploaded for this frame
+struct Instance {
+    vec4 mvp[4];
+    vec4 normal_matrix[3];
+    vec4 color;
+};
+
+// CullMesh in sdlgpu_culling.c
+struct CullMesh {
+    float radius;         // bounding sphere around the mesh origin
+    uint first_instance;  // where the mesh's run starts in the visible instance buffer
+    uint padding[2];
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer Instances {
+    Instance instances[];
+};
+
+layout(std430, set = 0, binding = 1) readonly buffer GearMeshes {
+    uint gear_mesh[]; // GearLayout.mesh
+};
+
+layout(std430, set = 0, binding = 2) readonly buffer Meshes {
+    CullMesh meshes[];
+};
+
+layout(std430, set = 1, binding = 0) writeonly buffer Visible {
+    Instance visible[];
+};
+
+// SDL_GPUIndexedIndirectDrawCommand per mesh, num_instances (word 1) starts at 0
+layout(std430, set = 1, binding = 1) buffer Draws {
+    uint draw_words[];
+};
+
+layout(set = 2, binding = 0) uniform UniformBuffer {
+    uint gear_count;
+} ubo;
+
+// row i of the column-major mvp matrix
+vec4 mvp_row(Instance instance, int i) {
+    return vec4(instance.mvp[0][i], instance.mvp[1][i], instance.mvp[2][i], instance.mvp[3][i]);
+}
+
+// the six clip planes of the mvp matrix (Gribb/Hartmann), tested against a sphere at the model origin
+// model and view are rigid, so the normalized plane distance is in world units like the radius
+bool sphere_visible(Instance instance, float radius) {
+    vec4 x = mvp_row(instance, 0);
+    vec4 y = mvp_row(instance, 1);
+    vec4 z = mvp_row(instance, 2);
+    vec4 w = mvp_row(instance, 3);
+
+    vec4 planes[6] = vec4[6](w + x, w - x, w + y, w - y, w + z, w - z);
+    for (int p = 0; p < 6; p++) {
+        if (planes[p].w < -radius * length(planes[p].xyz))
+            return false;
+    }
+    return true;
+}
+
+void main() {
+    uint gear = gl_GlobalInvocationID.x;
+    if (gear >= ubo.gear_count)
+        return;
+
+    Instance instance = instances[gear];
+    uint mesh = gear_mesh[gear];
+    if (!sphere_visible(instance, meshes[mesh].radius))
+        return;
+
+    uint slot = atomicAdd(draw_words[mesh * 5u + 1u], 1u);
+    visible[meshes[mesh].first_instance + slot] = instance;
+}
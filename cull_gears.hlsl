@@ -0,0 +1,73 @@
+// frustum culling for RENDER_INDIRECT, one thread per gear
+// every gear that survives is copied into its mesh's run of the visible instance buffer and counted in that mesh's indirect draw
+
+// InstanceData in sdlgpu_render.h, as uploaded for this frame
+struct Instance {
+    float4 mvp[4];
+    float4 normal_matrix[3];
+    float4 color;
+};
+
+// CullMesh in sdlgpu_culling.c
+struct CullMesh {
+    float radius;        // bounding sphere around the mesh origin
+    uint first_instance; // where the mesh's run starts in the visible instance buffer
+    uint2 padding;
+};
+
+StructuredBuffer<Instance> instances : register(t0, space0);
+StructuredBuffer<uint> gear_mesh : register(t1, space0); // GearLayout.mesh
+StructuredBuffer<CullMesh> meshes : register(t2, space0);
+
+// Instance and SDL_GPUIndexedIndirectDrawCommand per mesh, num_instances (word 1) starts at 0
+RWByteAddressBuffer visible : register(u0, space1);
+RWByteAddressBuffer draws : register(u1, space1);
+
+cbuffer UniformBuffer : register(b0, space2) {
+    uint gear_count;
+};
+
+#define INSTANCE_SIZE 128
+
+// row i of the column-major mvp matrix
+float4 mvp_row(Instance instance, int i) {
+    return float4(instance.mvp[0][i], instance.mvp[1][i], instance.mvp[2][i], instance.mvp[3][i]);
+}
+
+// the six clip planes of the mvp matrix (Gribb/Hartmann), tested against a sphere at the model origin
+// model and view are rigid, so the normalized plane distance is in world units like the radius
+bool sphere_visible(Instance instance, float radius) {
+    float4 x = mvp_row(instance, 0);
+    float4 y = mvp_row(instance, 1);
+    float4 z = mvp_row(instance, 2);
+    float4 w = mvp_row(instance, 3);
+
+    float4 planes[6] = {w + x, w - x, w + y, w - y, w + z, w - z};
+    for (int p = 0; p < 6; p++) {
+        if (planes[p].w < -radius * length(planes[p].xyz))
+            return false;
+    }
+    return true;
+}
+
+[numthreads(64, 1, 1)]
+void main(uint3 id : SV_DispatchThreadID) {
+    uint gear = id.x;
+    if (gear >= gear_count)
+        return;
+
+    Instance instance = instances[gear];
+    uint mesh = gear_mesh[gear];
+    if (!sphere_visible(instance, meshes[mesh].radius))
+        return;
+
+    uint slot;
+    draws.InterlockedAdd((mesh * 5 + 1) * 4, 1, slot);
+
+    uint at = (meshes[mesh].first_instance + slot) * INSTANCE_SIZE;
+    for (int c = 0; c < 4; c++)
+        visible.Store4(at + c * 16, asuint(instance.mvp[c]));
+    for (int n = 0; n < 3; n++)
+        visible.Store4(at + 64 + n * 16, asuint(instance.normal_matrix[n]));
+    visible.Store4(at + 112, asuint(instance.color));
+}
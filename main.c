@@ -26,11 +26,25 @@
 
 #include <SDL3/SDL_events.h>
 #include <SDL3/SDL_hints.h>
+#include <SDL3/SDL_gpu.h>
 #include <SDL3/SDL_init.h>
+#include <SDL3/SDL_timer.h>
 #include <SDL3/SDL_video.h>
 
 #include "sdlgpu_init.h"
+#include "sdlgpu_jobs.h"
 #include "sdlgpu_render.h"
+#include "sdlgpu_render_thread.h"
+#include "sdlgpu_targets.h"
+#include "sdlgpu_timing.h"
+#include "sdlgpu_trace.h"
+#include "sdlgpu_tuner.h"
+
+/* where -tune saves its result, and where it's loaded from otherwise */
+#define DEFAULT_TUNE_FILE "sdlgpu_gears.cfg"
+
+/* 64 MiB at 32 bytes each, about 100k frames at the ~16-20 events a frame records (well under a minute when uncapped) */
+#define TRACE_MAX_EVENTS (1u << 21)
 
 /* event handler results */
 typedef enum Action
@@ -40,43 +54,86 @@ typedef enum Action
 	DRAW = 2
 } Action;
 
-static Action handle_event(SDL_Event *event)
+/* the state input starts from */
+static ViewInput initial_view_input(SDL_Window *window)
+{
+	ViewInput input = {.view_rotx = render_state.view_rotx,
+	                   .view_roty = render_state.view_roty,
+	                   .view_rotz = render_state.view_rotz,
+	                   .pause_animation = render_state.pause_animation,
+	                   .input_time = render_state.input_time,
+	                   .present_mode = render_state.present_mode,
+	                   .frames_in_flight = render_state.frames_in_flight,
+	                   .width = 0,
+	                   .height = 0};
+
+	SDL_GetWindowSizeInPixels(window, &input.width, &input.height);
+	return input;
+}
+
+static void next_present_mode(SDL_Window *window, ViewInput *input)
+{
+	/* unsupported modes fall back to VSYNC, so skip ahead until something actually changes */
+	PresentMode previous = input->present_mode;
+	for (int step = 1; step < 3 && input->present_mode == previous; step++)
+		input->present_mode = set_present_mode(window, previous, (PresentMode)((previous + step) % 3));
+}
+
+static void next_frames_in_flight(SDL_Window *window, ViewInput *input)
+{
+	input->frames_in_flight = set_frames_in_flight(window, input->frames_in_flight, input->frames_in_flight % MAX_FRAMES_IN_FLIGHT + 1);
+}
+
+/* input only changes *input, the caller hands it to whoever draws
+ * this runs on the thread that created the window either way, so it's also where the swapchain is reconfigured */
+static Action handle_event(SDL_Window *window, SDL_Event *event, ViewInput *input)
 {
 	switch (event->type)
 	{
 	case SDL_EVENT_QUIT:
 		return EXIT;
 	case SDL_EVENT_KEY_DOWN:
+		input->input_time = event->key.timestamp;
 		switch (event->key.key)
 		{
 		case SDLK_LEFT:
-			render_state.view_roty += 5.0f;
+			input->view_roty += 5.0f;
 			break;
 		case SDLK_RIGHT:
-			render_state.view_roty -= 5.0f;
+			input->view_roty -= 5.0f;
 			break;
 		case SDLK_UP:
-			render_state.view_rotx += 5.0f;
+			input->view_rotx += 5.0f;
 			break;
 		case SDLK_DOWN:
-			render_state.view_rotx -= 5.0f;
+			input->view_rotx -= 5.0f;
 			break;
 		case SDLK_ESCAPE:
 			return EXIT;
 		case SDLK_A:
-			render_state.pause_animation = !render_state.pause_animation;
+			input->pause_animation = !input->pause_animation;
+			break;
+		/* the tuner owns the present configuration until it's done, switching it would skew the one being measured */
+		case SDLK_P:
+			if (!tuner_active())
+				next_present_mode(window, input);
+			break;
+		case SDLK_F:
+			if (!tuner_active())
+				next_frames_in_flight(window, input);
 			break;
 		default:
 			break;
 		}
 		return DRAW;
-	case SDL_EVENT_WINDOW_EXPOSED:
+	case SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED:
+		/* only the render thread's frames need to be told, see sdlgpu_render_thread.h */
+		input->width = event->window.data1;
+		input->height = event->window.data2;
 		return DRAW;
+	case SDL_EVENT_WINDOW_EXPOSED:
 	case SDL_EVENT_WINDOW_RESIZED:
-	case SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED:
-		/* invalidate now, so that we can wait until the gpu is idle to recreate the swapchain with the right size
-		 * this might be an SDL_gpu bug, because i'm pretty sure it's supposed to handle resizing internally */
-		render_state.swapchain_valid = 0;
+		/* the swapchain follows the window by itself, and draw_frame() replaces the depth target once it sees the new size */
 		return DRAW;
 	default:
 		break;
@@ -84,7 +141,7 @@ static Action handle_event(SDL_Event *event)
 	return NOP;
 }
 
-static void event_loop(SDL_Window *window)
+static void event_loop(SDL_Window *window, ViewInput *input)
 {
 	SDL_Event event;
 
@@ -92,20 +149,91 @@ static void event_loop(SDL_Window *window)
 	{
 		int op = NOP;
 
-		while (render_state.pause_animation || SDL_PollEvent(&event))
+		trace_begin("handle_events");
+		while (input->pause_animation || SDL_PollEvent(&event))
 		{
-			if (render_state.pause_animation)
+			if (input->pause_animation)
 				SDL_WaitEvent(&event);
 
-			op = handle_event(&event);
+			op = handle_event(window, &event, input);
 			if (op == EXIT)
+			{
+				trace_end("handle_events");
 				return;
-			if (op == DRAW)
+			}
+			if (op != NOP)
 				break;
 		}
+		trace_end("handle_events");
+
+		apply_view_input(input);
+		if (draw_frame(window))
+			tuner_frame(window, input);
+	}
+}
+
+/* event_loop() with draw_frame() on a render thread, so neither a swapchain wait nor an event storm holds up the other
+ * this thread still presents what it draws, see sdlgpu_render_thread.h */
+static void event_loop_threaded(SDL_Window *window, ViewInput *input)
+{
+	SDL_Event event;
+
+	if (!render_thread_start(window, input))
+	{
+		event_loop(window, input);
+		return;
+	}
 
-		draw_frame(window);
+	/* nothing to poll for anymore, the render thread keeps drawing on its own and says when it has a frame */
+	while (SDL_WaitEvent(&event))
+	{
+		if (render_thread_handle_event(&event))
+			continue;
+
+		int op = handle_event(window, &event, input);
+		if (op == EXIT)
+			break;
+		if (op == NOP)
+			continue;
+
+		render_thread_set_input(input);
+		render_thread_send(RENDER_CMD_REDRAW);
 	}
+
+	render_thread_stop();
+}
+
+/* render a fixed number of frames headless, at a fixed timestep, then report throughput */
+static void benchmark_loop(unsigned int num_frames)
+{
+	/* a few untimed frames first, so pipeline/driver warm-up doesn't skew short runs */
+	unsigned int warmup = SDL_min(num_frames, 10u);
+	for (unsigned int i = 0; i < warmup; i++)
+		draw_frame(NULL);
+	SDL_WaitForGPUIdle(render_state.device);
+
+	Uint64 start = SDL_GetTicksNS();
+	for (unsigned int i = 0; i < num_frames; i++)
+		draw_frame(NULL);
+	SDL_WaitForGPUIdle(render_state.device); /* count the gpu work for the last frames too */
+	Uint64 end = SDL_GetTicksNS();
+
+	uint64_t triangles = 0;
+	for (uint32_t i = 0; i < render_state.layout.count; i++)
+		triangles += render_state.gears[render_state.layout.mesh[i]].index_count / 3;
+
+	double seconds = (double)(end - start) / (double)SDL_NS_PER_SECOND;
+	if (seconds <= 0.0)
+		seconds = 1e-9;
+
+	printf("Benchmark: %u frames of %u gears at %ux%u in %.3f seconds\n", num_frames, render_state.layout.count, render_state.offscreen_width,
+	       render_state.offscreen_height, seconds);
+	printf("  %10.3f FPS\n", num_frames / seconds);
+	printf("  %10.3f ms/frame\n", 1000.0 * seconds / num_frames);
+	printf("  %10.3f Mgears/s\n", (double)num_frames * render_state.layout.count / seconds / 1e6);
+	printf("  %10.3f Mtris/s\n", (double)num_frames * (double)triangles / seconds / 1e6);
+	timing_report();
+	render_targets_report();
 }
 
 static void usage(void)
@@ -115,8 +243,23 @@ static void usage(void)
 	printf("  -fullscreen             run in fullscreen mode\n");
 	printf("  -info                   display GPU renderer info\n");
 	printf("  -geometry WxH+X+Y       window geometry\n");
-	printf("  -present_mode MODE      presentation mode: vsync, immediate, mailbox (default: mailbox)\n");
-	printf("  -image_count N          force the maximum number of frames queued on the gpu (default: 2, min: 1, max: 3)\n");
+	printf("  -present_mode MODE      presentation mode: vsync, immediate, mailbox (default: mailbox, P cycles at runtime)\n");
+	printf("  -image_count N          force the maximum number of frames queued on the gpu (default: 2, min: 1, max: 3, F cycles at runtime)\n");
+	printf("  -render_mode MODE       gear submission: classic, instanced, procedural, indirect (gpu culled) (default: classic)\n");
+	printf("  -vertex_format FORMAT   gear vertex layout: full (24 bytes), compact (12 bytes, half position + octahedral normal) (default: full)\n");
+	printf("  -mesh_gen WHERE         build the gear meshes on the: cpu, gpu (compute shader, unwelded) (default: cpu)\n");
+	printf("  -verify_mesh_gen        build the gear meshes on the gpu and check them against the cpu generator, exits on mismatch\n");
+	printf("  -cpu_cull               skip gears outside the view frustum with a cpu spatial index (not with -render_mode indirect)\n");
+	printf("  -gears N                lay out N meshing gears as a grid of glxgears trios (default: 3)\n");
+	printf("  -tune OBJECTIVE         measure every supported present mode x image count, then use and save the best for: latency, throughput,\n"
+	       "                          smoothness (keep the animation running while it does)\n");
+	printf("  -tune_file FILE         where -tune saves its choice, loaded on later runs unless overridden (default: " DEFAULT_TUNE_FILE ")\n");
+	printf("  -render_thread          render on a separate thread from event handling; swapchain acquire and present stay on the window's\n"
+	       "                          thread as SDL requires, which blits each finished frame into it (not with -tune)\n");
+	printf("  -threads N              threads for per-frame and startup CPU work, 0 for one per core, 1 for none besides the main one (default: 0)\n");
+	printf("  -timing FILE            write per-frame phase timings to FILE on exit (JSON if it ends in .json, CSV otherwise)\n");
+	printf("  -trace FILE             record a Chrome/Perfetto trace-event JSON of the render loop to FILE\n");
+	printf("  -benchmark N            render N frames headless (size from -geometry) at a fixed 60Hz timestep, then print throughput\n");
 #ifdef _WIN32
 	printf("  -vulkan                 use the Vulkan backend instead of D3D12\n");
 #define D3D_POSSIBLE 1
@@ -138,11 +281,26 @@ int main(int argc, char *argv[])
 	(void)samples;
 
 	bool fullscreen = false;
+	unsigned int benchmark_frames = 0;
+	const char *timing_file = NULL;
+	const char *trace_file = NULL;
+	unsigned int num_threads = 0;
+	bool use_render_thread = false;
+	bool tune = false;
+	TuneObjective tune_objective = TUNE_LATENCY;
+	const char *tune_file = DEFAULT_TUNE_FILE;
+	bool present_mode_given = false, image_count_given = false; /* these take precedence over the tune file */
 
 	InitParams cfg = {.window = NULL,
 	                  .present_mode = MAILBOX, /* prefer mailbox, fallback to vsync */
 	                  .renderer = DEFAULT,     /* d3d12 on Windows, Vulkan otherwise */
+	                  .render_mode = RENDER_CLASSIC,
+	                  .vertex_format = VERTEX_FULL,
+	                  .mesh_generator = MESHGEN_CPU,
+	                  .verify_meshes = false,
+	                  .cpu_culling = false,
 	                  .image_count = 2,
+	                  .num_gears = 3,
 	                  .verbose = false};
 
 	for (int i = 1; i < argc; i++)
@@ -171,6 +329,31 @@ int main(int argc, char *argv[])
 			{
 				cfg.image_count = 3;
 			}
+			image_count_given = true;
+			++i;
+		}
+		else if (i < argc - 1 && strcmp(argv[i], "-gears") == 0)
+		{
+			cfg.num_gears = (unsigned int)strtoul(argv[i + 1], NULL, 0);
+			if (cfg.num_gears < 1)
+				cfg.num_gears = 1;
+			++i;
+		}
+		else if (i < argc - 1 && strcmp(argv[i], "-benchmark") == 0)
+		{
+			benchmark_frames = (unsigned int)strtoul(argv[i + 1], NULL, 0);
+			if (benchmark_frames < 1)
+				benchmark_frames = 1;
+			++i;
+		}
+		else if (i < argc - 1 && strcmp(argv[i], "-timing") == 0)
+		{
+			timing_file = argv[i + 1];
+			++i;
+		}
+		else if (i < argc - 1 && strcmp(argv[i], "-trace") == 0)
+		{
+			trace_file = argv[i + 1];
 			++i;
 		}
 		else if (strcmp(argv[i], "-fullscreen") == 0)
@@ -198,8 +381,121 @@ int main(int argc, char *argv[])
 				usage();
 				return -1;
 			}
+			present_mode_given = true;
+			i++;
+		}
+		else if (i < argc - 1 && strcmp(argv[i], "-render_mode") == 0)
+		{
+			char *mode = argv[i + 1];
+			if (strcmp(mode, "classic") == 0)
+			{
+				cfg.render_mode = RENDER_CLASSIC;
+			}
+			else if (strcmp(mode, "instanced") == 0)
+			{
+				cfg.render_mode = RENDER_INSTANCED;
+			}
+			else if (strcmp(mode, "procedural") == 0)
+			{
+				cfg.render_mode = RENDER_PROCEDURAL;
+			}
+			else if (strcmp(mode, "indirect") == 0)
+			{
+				cfg.render_mode = RENDER_INDIRECT;
+			}
+			else
+			{
+				printf("Error: invalid render mode '%s'\n", mode);
+				usage();
+				return -1;
+			}
+			i++;
+		}
+		else if (i < argc - 1 && strcmp(argv[i], "-vertex_format") == 0)
+		{
+			char *format = argv[i + 1];
+			if (strcmp(format, "full") == 0)
+			{
+				cfg.vertex_format = VERTEX_FULL;
+			}
+			else if (strcmp(format, "compact") == 0)
+			{
+				cfg.vertex_format = VERTEX_COMPACT;
+			}
+			else
+			{
+				printf("Error: invalid vertex format '%s'\n", format);
+				usage();
+				return -1;
+			}
+			i++;
+		}
+		else if (i < argc - 1 && strcmp(argv[i], "-tune") == 0)
+		{
+			char *objective = argv[i + 1];
+			if (strcmp(objective, "latency") == 0)
+			{
+				tune_objective = TUNE_LATENCY;
+			}
+			else if (strcmp(objective, "throughput") == 0)
+			{
+				tune_objective = TUNE_THROUGHPUT;
+			}
+			else if (strcmp(objective, "smoothness") == 0)
+			{
+				tune_objective = TUNE_SMOOTHNESS;
+			}
+			else
+			{
+				printf("Error: invalid tuning objective '%s'\n", objective);
+				usage();
+				return -1;
+			}
+			tune = true;
+			i++;
+		}
+		else if (i < argc - 1 && strcmp(argv[i], "-tune_file") == 0)
+		{
+			tune_file = argv[i + 1];
 			i++;
 		}
+		else if (strcmp(argv[i], "-render_thread") == 0)
+		{
+			use_render_thread = true;
+		}
+		else if (i < argc - 1 && strcmp(argv[i], "-threads") == 0)
+		{
+			num_threads = (unsigned int)strtoul(argv[i + 1], NULL, 0);
+			i++;
+		}
+		else if (i < argc - 1 && strcmp(argv[i], "-mesh_gen") == 0)
+		{
+			char *generator = argv[i + 1];
+			if (strcmp(generator, "cpu") == 0)
+			{
+				cfg.mesh_generator = MESHGEN_CPU;
+			}
+			else if (strcmp(generator, "gpu") == 0)
+			{
+				cfg.mesh_generator = MESHGEN_GPU;
+			}
+			else
+			{
+				printf("Error: invalid mesh generator '%s'\n", generator);
+				usage();
+				return -1;
+			}
+			i++;
+		}
+		else if (strcmp(argv[i], "-verify_mesh_gen") == 0)
+		{
+			cfg.mesh_generator = MESHGEN_GPU;
+			cfg.verify_meshes = true;
+		}
+		else if (strcmp(argv[i], "-cpu_cull") == 0)
+		{
+			cfg.cpu_culling = true;
+		}
 		else if (i < argc - 1 && strcmp(argv[i], "-geometry") == 0)
 		{
 			char *geom = argv[i + 1];
@@ -236,6 +532,11 @@ int main(int argc, char *argv[])
 		}
 	}
 
+	/* a previous -tune run's choice, unless it's being redone or overridden */
+	if (!tune && !benchmark_frames && !(present_mode_given && image_count_given) &&
+	    tuner_load(tune_file, present_mode_given ? NULL : &cfg.present_mode, image_count_given ? NULL : &cfg.image_count))
+		printf("Loaded present configuration from %s\n", tune_file);
+
 	/* also respect SDL hint */
 	if (D3D_POSSIBLE && cfg.renderer != VULKAN)
 	{
@@ -246,12 +547,51 @@ int main(int argc, char *argv[])
 		}
 	}
 
+	/* no window is ever created for the benchmark, so don't require a display either (lavapipe etc. works through these) */
+	if (benchmark_frames && !SDL_GetHint(SDL_HINT_VIDEO_DRIVER))
+		SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen,dummy");
+
 	if (!SDL_Init(SDL_INIT_VIDEO))
 	{
 		printf("Error: couldn't initialize SDL: %s\n", SDL_GetError());
 		return -1;
 	}
 
+	/* started early, so that gear creation shows up in the trace */
+	if (trace_file)
+		trace_init(trace_file, TRACE_MAX_EVENTS);
+
+	/* a failure here just leaves everything on the main thread */
+	jobs_init(num_threads);
+
+	if (benchmark_frames)
+	{
+		cfg.offscreen_width = (unsigned int)SDL_max(win_width, 1);
+		cfg.offscreen_height = (unsigned int)SDL_max(win_height, 1);
+
+		if (!init_gpu(&cfg))
+		{
+			cleanup_gpu();
+			jobs_shutdown();
+			trace_shutdown();
+			SDL_Quit();
+			return -1;
+		}
+
+		render_state.fixed_timestep = 1.0 / 60.0;
+		printf("Renderer: %s\n", cfg.renderer == D3D12 ? "Direct3D12" : "Vulkan");
+		benchmark_loop(benchmark_frames);
+
+		if (timing_file)
+			timing_export(timing_file);
+
+		cleanup_gpu();
+		jobs_shutdown();
+		trace_shutdown();
+		SDL_Quit();
+		return 0;
+	}
+
 	SDL_PropertiesID props = SDL_CreateProperties();
 	SDL_SetStringProperty(props, SDL_PROP_WINDOW_CREATE_TITLE_STRING, WINDOW_TITLE);
 	SDL_SetNumberProperty(props, SDL_PROP_WINDOW_CREATE_X_NUMBER, x);
@@ -267,6 +607,8 @@ int main(int argc, char *argv[])
 	if (!cfg.window)
 	{
 		printf("Error: couldn't create window: %s\n", SDL_GetError());
+		jobs_shutdown();
+		trace_shutdown();
 		SDL_Quit();
 		return -1;
 	}
@@ -278,6 +620,8 @@ int main(int argc, char *argv[])
 	if (!init_gpu(&cfg))
 	{
 		cleanup_gpu();
+		jobs_shutdown();
+		trace_shutdown();
 		SDL_DestroyWindow(cfg.window);
 		SDL_Quit();
 		return -1;
@@ -286,9 +630,29 @@ int main(int argc, char *argv[])
 	const char *title_with_renderer = (cfg.renderer == D3D12 ? WINDOW_TITLE " (Direct3D12)" : WINDOW_TITLE " (Vulkan)");
 	SDL_SetWindowTitle(cfg.window, title_with_renderer);
 
-	event_loop(cfg.window);
+	ViewInput input = initial_view_input(cfg.window);
+
+	/* the tuner measures draw_frame() and switches the swapchain in between, which needs both on the same thread */
+	if (tune && use_render_thread)
+	{
+		printf("Notice: -tune runs without -render_thread\n");
+		use_render_thread = false;
+	}
+
+	if (tune)
+		tuner_start(cfg.window, &input, tune_objective, tune_file);
+
+	if (use_render_thread)
+		event_loop_threaded(cfg.window, &input);
+	else
+		event_loop(cfg.window, &input);
+
+	if (timing_file)
+		timing_export(timing_file);
 
 	cleanup_gpu();
+	jobs_shutdown();
+	trace_shutdown();
 	SDL_DestroyWindow(cfg.window);
 	SDL_Quit();
 
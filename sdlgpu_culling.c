@@ -0,0 +1,241 @@
+/*
+ * Copyright (C) 2025 William Horvath
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <SDL3/SDL_gpu.h>
+
+#include "sdlgpu_culling.h"
+#include "sdlgpu_gear_creation.h"
+#include "sdlgpu_render.h"
+#include "sdlgpu_shader_data.h"
+
+/* must match local_size_x/numthreads in cull_gears.glsl/hlsl */
+#define CULL_THREADS 64
+
+/* CullMesh in cull_gears.glsl/hlsl (std430/structured buffer layout) */
+typedef struct CullMesh
+{
+	float radius;
+	uint32_t first_instance;
+	uint32_t padding[2];
+} CullMesh;
+
+typedef struct CullUniforms
+{
+	uint32_t gear_count;
+	uint32_t padding[3];
+} CullUniforms;
+
+static struct
+{
+	SDL_GPUComputePipeline *pipeline;
+	SDL_GPUBuffer *visible_buffer;    /* the survivors, grouped by mesh like the layout, read as instance data by the draws */
+	SDL_GPUBuffer *draw_buffer;       /* one SDL_GPUIndexedIndirectDrawCommand per mesh */
+	SDL_GPUBuffer *draw_reset_buffer; /* draw_buffer with every num_instances at 0, copied over it each frame */
+	SDL_GPUBuffer *gear_mesh_buffer;  /* GearLayout.mesh */
+	SDL_GPUBuffer *mesh_buffer;       /* CullMesh per mesh */
+	uint32_t num_meshes;
+} culling;
+
+static SDL_GPUComputePipeline *create_cull_pipeline(SDL_GPUDevice *device)
+{
+	SDL_GPUComputePipelineCreateInfo info = {.entrypoint = "main",
+	                                         .num_samplers = 0,
+	                                         .num_readonly_storage_textures = 0,
+	                                         .num_readonly_storage_buffers = 3,
+	                                         .num_readwrite_storage_textures = 0,
+	                                         .num_readwrite_storage_buffers = 2,
+	                                         .num_uniform_buffers = 1,
+	                                         .threadcount_x = CULL_THREADS,
+	                                         .threadcount_y = 1,
+	                                         .threadcount_z = 1,
+	                                         .props = 0};
+
+	if (SDL_GetGPUShaderFormats(device) & SDL_GPU_SHADERFORMAT_SPIRV)
+	{
+		info.format = SDL_GPU_SHADERFORMAT_SPIRV;
+		info.code = csh_cull_spv;
+		info.code_size = csh_cull_spv_size();
+	}
+	else
+	{
+		info.format = SDL_GPU_SHADERFORMAT_DXIL;
+		info.code = csh_cull_dx;
+		info.code_size = csh_cull_dx_size();
+	}
+
+	return SDL_CreateGPUComputePipeline(device, &info);
+}
+
+/* the static inputs: draw templates, the mesh of every gear and the bounds of every mesh */
+static bool upload_cull_data(SDL_GPUDevice *device)
+{
+	const GearLayout *layout = &render_state.layout;
+	uint32_t draws_bytes = culling.num_meshes * (uint32_t)sizeof(SDL_GPUIndexedIndirectDrawCommand);
+	uint32_t gear_mesh_bytes = layout->count * (uint32_t)sizeof(uint32_t);
+	uint32_t meshes_bytes = culling.num_meshes * (uint32_t)sizeof(CullMesh);
+
+	SDL_GPUTransferBufferCreateInfo transfer_info = {.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD, .size = draws_bytes + gear_mesh_bytes + meshes_bytes, .props = 0};
+
+	SDL_GPUTransferBuffer *transfer_buffer = SDL_CreateGPUTransferBuffer(device, &transfer_info);
+	unsigned char *mapped = transfer_buffer ? (unsigned char *)SDL_MapGPUTransferBuffer(device, transfer_buffer, false) : NULL;
+	if (!mapped)
+	{
+		printf("Failed to create transfer buffer: %s\n", SDL_GetError());
+		if (transfer_buffer)
+			SDL_ReleaseGPUTransferBuffer(device, transfer_buffer);
+		return false;
+	}
+
+	SDL_GPUIndexedIndirectDrawCommand *draws = (SDL_GPUIndexedIndirectDrawCommand *)mapped;
+	CullMesh *meshes = (CullMesh *)(mapped + draws_bytes + gear_mesh_bytes);
+	memcpy(mapped + draws_bytes, layout->mesh, gear_mesh_bytes);
+
+	for (uint32_t m = 0; m < culling.num_meshes; m++)
+	{
+		/* the layout keeps each mesh's gears together, so its run starts at its first gear */
+		uint32_t first_instance = 0;
+		while (first_instance < layout->count && layout->mesh[first_instance] != m)
+			first_instance++;
+		if (first_instance == layout->count)
+			first_instance = 0; /* unused mesh, its draw stays empty */
+
+		const GearData *mesh = &render_state.gears[m];
+		draws[m] = (SDL_GPUIndexedIndirectDrawCommand){.num_indices = mesh->index_count,
+		                                               .num_instances = 0,
+		                                               .first_index = mesh->first_index,
+		                                               .vertex_offset = mesh->vertex_offset,
+		                                               .first_instance = first_instance};
+
+		meshes[m] = (CullMesh){.radius = gear_bounding_radius(&render_state.gear_params[m]), .first_instance = first_instance, .padding = {0, 0}};
+	}
+
+	SDL_UnmapGPUTransferBuffer(device, transfer_buffer);
+
+	SDL_GPUCommandBuffer *cmd = SDL_AcquireGPUCommandBuffer(device);
+	if (!cmd)
+	{
+		printf("Failed to acquire command buffer: %s\n", SDL_GetError());
+		SDL_ReleaseGPUTransferBuffer(device, transfer_buffer);
+		return false;
+	}
+
+	SDL_GPUCopyPass *copy_pass = SDL_BeginGPUCopyPass(cmd);
+
+	SDL_GPUTransferBufferLocation src = {transfer_buffer, 0};
+	SDL_GPUBufferRegion dst = {culling.draw_reset_buffer, 0, draws_bytes};
+	SDL_UploadToGPUBuffer(copy_pass, &src, &dst, false);
+
+	src.offset = draws_bytes;
+	dst = (SDL_GPUBufferRegion){culling.gear_mesh_buffer, 0, gear_mesh_bytes};
+	SDL_UploadToGPUBuffer(copy_pass, &src, &dst, false);
+
+	src.offset = draws_bytes + gear_mesh_bytes;
+	dst = (SDL_GPUBufferRegion){culling.mesh_buffer, 0, meshes_bytes};
+	SDL_UploadToGPUBuffer(copy_pass, &src, &dst, false);
+
+	SDL_EndGPUCopyPass(copy_pass);
+
+	/* the first frame is submitted after this, so nothing needs to wait for it */
+	bool submitted = SDL_SubmitGPUCommandBuffer(cmd);
+	SDL_ReleaseGPUTransferBuffer(device, transfer_buffer);
+	if (!submitted)
+		printf("Failed to upload culling data: %s\n", SDL_GetError());
+
+	return submitted;
+}
+
+bool create_culling(SDL_GPUDevice *device)
+{
+	culling.num_meshes = render_state.num_gears;
+
+	uint32_t draws_bytes = culling.num_meshes * (uint32_t)sizeof(SDL_GPUIndexedIndirectDrawCommand);
+
+	SDL_GPUBufferCreateInfo visible_info = {.usage = SDL_GPU_BUFFERUSAGE_VERTEX | SDL_GPU_BUFFERUSAGE_COMPUTE_STORAGE_WRITE,
+	                                        .size = (uint32_t)(render_state.layout.count * sizeof(InstanceData)),
+	                                        .props = 0};
+
+	SDL_GPUBufferCreateInfo draw_info = {.usage = SDL_GPU_BUFFERUSAGE_INDIRECT | SDL_GPU_BUFFERUSAGE_COMPUTE_STORAGE_WRITE, .size = draws_bytes, .props = 0};
+
+	SDL_GPUBufferCreateInfo draw_reset_info = {.usage = SDL_GPU_BUFFERUSAGE_COMPUTE_STORAGE_READ, .size = draws_bytes, .props = 0};
+
+	SDL_GPUBufferCreateInfo gear_mesh_info = {
+	    .usage = SDL_GPU_BUFFERUSAGE_COMPUTE_STORAGE_READ, .size = render_state.layout.count * (uint32_t)sizeof(uint32_t), .props = 0};
+
+	SDL_GPUBufferCreateInfo mesh_info = {.usage = SDL_GPU_BUFFERUSAGE_COMPUTE_STORAGE_READ, .size = culling.num_meshes * (uint32_t)sizeof(CullMesh), .props = 0};
+
+	culling.visible_buffer = SDL_CreateGPUBuffer(device, &visible_info);
+	culling.draw_buffer = SDL_CreateGPUBuffer(device, &draw_info);
+	culling.draw_reset_buffer = SDL_CreateGPUBuffer(device, &draw_reset_info);
+	culling.gear_mesh_buffer = SDL_CreateGPUBuffer(device, &gear_mesh_info);
+	culling.mesh_buffer = SDL_CreateGPUBuffer(device, &mesh_info);
+
+	if (!culling.visible_buffer || !culling.draw_buffer || !culling.draw_reset_buffer || !culling.gear_mesh_buffer || !culling.mesh_buffer)
+	{
+		printf("Failed to create culling buffers: %s\n", SDL_GetError());
+		return false;
+	}
+
+	culling.pipeline = create_cull_pipeline(device);
+	if (!culling.pipeline)
+	{
+		printf("Failed to create culling pipeline: %s\n", SDL_GetError());
+		return false;
+	}
+
+	return upload_cull_data(device);
+}
+
+void destroy_culling(SDL_GPUDevice *device)
+{
+	if (culling.pipeline)
+		SDL_ReleaseGPUComputePipeline(device, culling.pipeline);
+
+	SDL_GPUBuffer *buffers[] = {culling.visible_buffer, culling.draw_buffer, culling.draw_reset_buffer, culling.gear_mesh_buffer, culling.mesh_buffer};
+	for (size_t i = 0; i < SDL_arraysize(buffers); i++)
+	{
+		if (buffers[i])
+			SDL_ReleaseGPUBuffer(device, buffers[i]);
+	}
+
+	memset(&culling, 0, sizeof(culling));
+}
+
+void reset_culled_draws(SDL_GPUCopyPass *copy_pass)
+{
+	SDL_GPUBufferLocation src = {culling.draw_reset_buffer, 0};
+	SDL_GPUBufferLocation dst = {culling.draw_buffer, 0};
+
+	/* cycled, so the draws of frames still in flight keep their counts */
+	SDL_CopyGPUBufferToBuffer(copy_pass, &src, &dst, culling.num_meshes * (uint32_t)sizeof(SDL_GPUIndexedIndirectDrawCommand), true);
+}
+
+void cull_gears(SDL_GPUCommandBuffer *cmd, SDL_GPUBuffer *instance_buffer)
+{
+	/* the draw buffer was just reset by this frame's copy pass and must not be cycled away from that again */
+	SDL_GPUStorageBufferReadWriteBinding outputs[2] = {{.buffer = culling.visible_buffer, .cycle = true}, {.buffer = culling.draw_buffer, .cycle = false}};
+	SDL_GPUComputePass *compute_pass = SDL_BeginGPUComputePass(cmd, NULL, 0, outputs, 2);
+	SDL_BindGPUComputePipeline(compute_pass, culling.pipeline);
+
+	SDL_GPUBuffer *inputs[3] = {instance_buffer, culling.gear_mesh_buffer, culling.mesh_buffer};
+	SDL_BindGPUComputeStorageBuffers(compute_pass, 0, inputs, 3);
+
+	CullUniforms uniforms = {.gear_count = render_state.layout.count, .padding = {0, 0, 0}};
+	SDL_PushGPUComputeUniformData(cmd, 0, &uniforms, sizeof(uniforms));
+
+	SDL_DispatchGPUCompute(compute_pass, (render_state.layout.count + CULL_THREADS - 1) / CULL_THREADS, 1, 1);
+	SDL_EndGPUComputePass(compute_pass);
+}
+
+void draw_culled_gears(SDL_GPURenderPass *render_pass)
+{
+	/* the survivors take the place of the instance buffer at slot 1 */
+	SDL_GPUBufferBinding instance_binding = {.buffer = culling.visible_buffer, .offset = 0};
+	SDL_BindGPUVertexBuffers(render_pass, 1, &instance_binding, 1);
+
+	/* one draw per mesh, with however many of its instances survived */
+	SDL_DrawGPUIndexedPrimitivesIndirect(render_pass, culling.draw_buffer, 0, culling.num_meshes);
+}
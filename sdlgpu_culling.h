@@ -0,0 +1,24 @@
+/*
+ * Copyright (C) 2025 William Horvath
+ */
+
+#pragma once
+#include <stdbool.h>
+
+typedef struct SDL_GPUBuffer SDL_GPUBuffer;
+typedef struct SDL_GPUCommandBuffer SDL_GPUCommandBuffer;
+typedef struct SDL_GPUCopyPass SDL_GPUCopyPass;
+typedef struct SDL_GPUDevice SDL_GPUDevice;
+typedef struct SDL_GPURenderPass SDL_GPURenderPass;
+
+/* gpu frustum culling for RENDER_INDIRECT: cull_gears.glsl/hlsl tests every gear's bounding sphere against its mvp matrix,
+ * compacts the survivors into a second instance buffer and counts them into one SDL_GPUIndexedIndirectDrawCommand per mesh */
+
+/* create the pipeline and buffers for the current scene, after create_scene() */
+bool create_culling(SDL_GPUDevice *device);
+void destroy_culling(SDL_GPUDevice *device);
+
+/* per frame, in this order: zero the draw counts (in the instance upload's copy pass), cull, then draw inside the render pass */
+void reset_culled_draws(SDL_GPUCopyPass *copy_pass);
+void cull_gears(SDL_GPUCommandBuffer *cmd, SDL_GPUBuffer *instance_buffer);
+void draw_culled_gears(SDL_GPURenderPass *render_pass);
@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2025 William Horvath
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <SDL3/SDL_gpu.h>
+
+#include "sdlgpu_frames.h"
+#include "sdlgpu_render.h"
+#include "sdlgpu_trace.h"
+
+typedef enum RetiredType
+{
+	RETIRED_TEXTURE,
+	RETIRED_BUFFER,
+	RETIRED_TRANSFER_BUFFER
+} RetiredType;
+
+typedef struct Retired
+{
+	RetiredType type;
+	void *resource;
+	uint64_t serial; /* the submission being recorded when it was retired, every one before it may still use it */
+} Retired;
+
+static struct
+{
+	uint64_t submitted; /* serial of the next submission */
+	Retired *retired;
+	uint32_t num_retired;
+	uint32_t retired_capacity;
+} frames;
+
+static void release_resource(SDL_GPUDevice *device, const Retired *retired)
+{
+	switch (retired->type)
+	{
+	case RETIRED_TEXTURE:
+		SDL_ReleaseGPUTexture(device, (SDL_GPUTexture *)retired->resource);
+		break;
+	case RETIRED_BUFFER:
+		SDL_ReleaseGPUBuffer(device, (SDL_GPUBuffer *)retired->resource);
+		break;
+	case RETIRED_TRANSFER_BUFFER:
+		SDL_ReleaseGPUTransferBuffer(device, (SDL_GPUTransferBuffer *)retired->resource);
+		break;
+	}
+}
+
+/* release whatever no submission in flight can still be using */
+static void release_retired(SDL_GPUDevice *device)
+{
+	if (frames.num_retired == 0)
+		return;
+
+	/* poll the other slots too, so nothing waits a full trip around the ring for fences that have long signaled */
+	uint64_t oldest_pending = frames.submitted;
+	for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+	{
+		FrameResources *frame = &render_state.frames[i];
+		if (!frame->fence)
+			continue;
+		if (SDL_QueryGPUFence(device, frame->fence))
+		{
+			SDL_ReleaseGPUFence(device, frame->fence);
+			frame->fence = NULL;
+		}
+		else if (frame->serial < oldest_pending)
+		{
+			oldest_pending = frame->serial;
+		}
+	}
+
+	uint32_t kept = 0;
+	for (uint32_t i = 0; i < frames.num_retired; i++)
+	{
+		if (frames.retired[i].serial <= oldest_pending)
+			release_resource(device, &frames.retired[i]);
+		else
+			frames.retired[kept++] = frames.retired[i];
+	}
+	frames.num_retired = kept;
+}
+
+static void retire(RetiredType type, void *resource)
+{
+	if (!resource)
+		return;
+
+	Retired retired = {.type = type, .resource = resource, .serial = frames.submitted};
+
+	if (frames.num_retired == frames.retired_capacity)
+	{
+		uint32_t capacity = SDL_max(16u, frames.retired_capacity * 2);
+		Retired *grown = (Retired *)realloc(frames.retired, capacity * sizeof(Retired));
+		if (!grown)
+		{
+			/* the old way, stall instead of leaking */
+			printf("Failed to grow the retired resource queue, waiting for the gpu instead\n");
+			SDL_WaitForGPUIdle(render_state.device);
+			release_resource(render_state.device, &retired);
+			return;
+		}
+		frames.retired = grown;
+		frames.retired_capacity = capacity;
+	}
+
+	frames.retired[frames.num_retired++] = retired;
+}
+
+bool create_frame_resources(SDL_GPUDevice *device, uint32_t instance_bytes, uint32_t instance_usage)
+{
+	render_state.frame_slot = 0;
+
+	if (instance_bytes == 0)
+		return true;
+
+	SDL_GPUBufferCreateInfo instance_buffer_info = {.usage = instance_usage, .size = instance_bytes, .props = 0};
+	SDL_GPUTransferBufferCreateInfo instance_transfer_info = {.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD, .size = instance_bytes, .props = 0};
+
+	/* every slot, so apply_present_config() can go up to the maximum without allocating */
+	for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+	{
+		FrameResources *frame = &render_state.frames[i];
+		frame->instance_buffer = SDL_CreateGPUBuffer(device, &instance_buffer_info);
+		frame->instance_transfer_buffer = SDL_CreateGPUTransferBuffer(device, &instance_transfer_info);
+		if (!frame->instance_buffer || !frame->instance_transfer_buffer)
+		{
+			printf("Failed to create instance buffers for frame %u: %s\n", i, SDL_GetError());
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void destroy_frame_resources(SDL_GPUDevice *device)
+{
+	for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+	{
+		FrameResources *frame = &render_state.frames[i];
+		if (frame->fence)
+		{
+			SDL_WaitForGPUFences(device, true, &frame->fence, 1);
+			SDL_ReleaseGPUFence(device, frame->fence);
+		}
+		if (frame->instance_buffer)
+			SDL_ReleaseGPUBuffer(device, frame->instance_buffer);
+		if (frame->instance_transfer_buffer)
+			SDL_ReleaseGPUTransferBuffer(device, frame->instance_transfer_buffer);
+	}
+
+	/* nothing is in flight anymore */
+	for (uint32_t i = 0; i < frames.num_retired; i++)
+		release_resource(device, &frames.retired[i]);
+	free(frames.retired);
+
+	memset(render_state.frames, 0, sizeof(render_state.frames));
+	memset(&frames, 0, sizeof(frames));
+}
+
+FrameResources *acquire_frame_resources(void)
+{
+	FrameResources *frame = &render_state.frames[render_state.frame_slot];
+
+	/* with a swapchain this has usually signaled already, SDL_WaitAndAcquireGPUSwapchainTexture() throttles to the same depth */
+	if (frame->fence)
+	{
+		trace_begin("wait_for_fence");
+		SDL_WaitForGPUFences(render_state.device, true, &frame->fence, 1);
+		SDL_ReleaseGPUFence(render_state.device, frame->fence);
+		frame->fence = NULL;
+		trace_end("wait_for_fence");
+	}
+
+	release_retired(render_state.device);
+
+	return frame;
+}
+
+bool submit_frame(SDL_GPUCommandBuffer *cmd)
+{
+	FrameResources *frame = &render_state.frames[render_state.frame_slot];
+
+	frame->fence = SDL_SubmitGPUCommandBufferAndAcquireFence(cmd);
+	frame->serial = frames.submitted++;
+	render_state.frame_slot = (render_state.frame_slot + 1) % render_state.frames_in_flight;
+
+	if (!frame->fence)
+	{
+		printf("Failed to submit frame: %s\n", SDL_GetError());
+		return false;
+	}
+
+	return true;
+}
+
+uint32_t frames_pending(void)
+{
+	uint32_t pending = 0;
+	for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+	{
+		if (render_state.frames[i].fence && !SDL_QueryGPUFence(render_state.device, render_state.frames[i].fence))
+			pending++;
+	}
+	return pending;
+}
+
+void retire_texture(SDL_GPUTexture *texture)
+{
+	retire(RETIRED_TEXTURE, texture);
+}
+
+void retire_buffer(SDL_GPUBuffer *buffer)
+{
+	retire(RETIRED_BUFFER, buffer);
+}
+
+void retire_transfer_buffer(SDL_GPUTransferBuffer *transfer_buffer)
+{
+	retire(RETIRED_TRANSFER_BUFFER, transfer_buffer);
+}
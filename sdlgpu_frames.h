@@ -0,0 +1,39 @@
+/*
+ * Copyright (C) 2025 William Horvath
+ */
+
+#pragma once
+#include <stdbool.h>
+
+#include <stdint.h>
+
+typedef struct SDL_GPUBuffer SDL_GPUBuffer;
+typedef struct SDL_GPUCommandBuffer SDL_GPUCommandBuffer;
+typedef struct SDL_GPUDevice SDL_GPUDevice;
+typedef struct SDL_GPUTexture SDL_GPUTexture;
+typedef struct SDL_GPUTransferBuffer SDL_GPUTransferBuffer;
+typedef struct FrameResources FrameResources;
+
+/* ring of render_state.frames_in_flight FrameResources (out of MAX_FRAMES_IN_FLIGHT allocated ones): a frame records into one slot,
+ * submits with a fence for it and moves on, and a slot is only handed out again once that fence has signaled,
+ * so its buffers are rewritten without cycling or stalling the gpu */
+
+/* allocate the slots, instance_bytes may be 0 for render modes without instance data
+ * render_state.frames_in_flight must already be set, apply_present_config() may change it at any time after */
+bool create_frame_resources(SDL_GPUDevice *device, uint32_t instance_bytes, uint32_t instance_usage);
+/* waits for every frame in flight, then releases everything still retired */
+void destroy_frame_resources(SDL_GPUDevice *device);
+
+/* the slot for the next frame, after waiting for the gpu to finish the frame that last used it
+ * also releases the retired resources that no frame still in flight was submitted before */
+FrameResources *acquire_frame_resources(void);
+/* submit cmd as the frame recorded into the current slot and advance to the next one */
+bool submit_frame(SDL_GPUCommandBuffer *cmd);
+/* submitted frames the gpu hasn't finished yet */
+uint32_t frames_pending(void);
+
+/* release a resource once every frame submitted so far is done with it, instead of waiting for the gpu to go idle
+ * anything replaced while recording a frame (the depth target on resize, ...) goes through these, NULL is ignored */
+void retire_texture(SDL_GPUTexture *texture);
+void retire_buffer(SDL_GPUBuffer *buffer);
+void retire_transfer_buffer(SDL_GPUTransferBuffer *transfer_buffer);
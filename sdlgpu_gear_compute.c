@@ -0,0 +1,365 @@
+/*
+ * Copyright (C) 2025 William Horvath
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <SDL3/SDL_gpu.h>
+
+#include "sdlgpu_gear_compute.h"
+#include "sdlgpu_gear_creation.h"
+#include "sdlgpu_render.h"
+#include "sdlgpu_shader_data.h"
+#include "sdlgpu_trace.h"
+
+/* must match local_size_x/numthreads in compute_gears.glsl/hlsl */
+#define GEN_THREADS 64
+
+/* GearShape in compute_gears.glsl/hlsl (std430/structured buffer layout) */
+typedef struct GpuGearParams
+{
+	float shape[4]; /* inner_radius, outer_radius, width, tooth_depth */
+	uint32_t teeth;
+	uint32_t first_vertex;
+	uint32_t first_index;
+	uint32_t padding;
+} GpuGearParams;
+
+typedef struct GenUniforms
+{
+	uint32_t compact_vertices;
+	uint32_t short_indices;
+	uint32_t padding[2];
+} GenUniforms;
+
+/* the gpu evaluates cos/sin to about 2^-11 and VERTEX_COMPACT rounds positions to half precision */
+#define VERIFY_TOLERANCE 1e-2f
+
+static SDL_GPUComputePipeline *create_gen_pipeline(SDL_GPUDevice *device)
+{
+	SDL_GPUComputePipelineCreateInfo info = {.entrypoint = "main",
+	                                         .num_samplers = 0,
+	                                         .num_readonly_storage_textures = 0,
+	                                         .num_readonly_storage_buffers = 1,
+	                                         .num_readwrite_storage_textures = 0,
+	                                         .num_readwrite_storage_buffers = 2,
+	                                         .num_uniform_buffers = 1,
+	                                         .threadcount_x = GEN_THREADS,
+	                                         .threadcount_y = 1,
+	                                         .threadcount_z = 1,
+	                                         .props = 0};
+
+	if (SDL_GetGPUShaderFormats(device) & SDL_GPU_SHADERFORMAT_SPIRV)
+	{
+		info.format = SDL_GPU_SHADERFORMAT_SPIRV;
+		info.code = csh_gears_spv;
+		info.code_size = csh_gears_spv_size();
+	}
+	else
+	{
+		info.format = SDL_GPU_SHADERFORMAT_DXIL;
+		info.code = csh_gears_dx;
+		info.code_size = csh_gears_dx_size();
+	}
+
+	return SDL_CreateGPUComputePipeline(device, &info);
+}
+
+bool create_gears_gpu(SDL_GPUDevice *device, GeometryPool *pool, GearData *gears, const GearParams *params, uint32_t count, SDL_GPUFence **gen_fence)
+{
+	*gen_fence = NULL;
+	memset(pool, 0, sizeof(*pool));
+
+	uint32_t vertex_size = render_state.vertex_format == VERTEX_COMPACT ? sizeof(CompactVertex) : sizeof(Vertex);
+
+	GpuGearParams *gpu_params = (GpuGearParams *)calloc(count, sizeof(GpuGearParams));
+	if (!gpu_params)
+	{
+		printf("Failed to allocate gear parameters\n");
+		return false;
+	}
+
+	/* same packing as create_gears(), minus the welding */
+	uint32_t max_mesh_vertices = 0;
+	uint32_t max_teeth = 0;
+	for (uint32_t g = 0; g < count; g++)
+	{
+		const GearParams *gear = &params[g];
+		uint32_t mesh_vertices = gear_vertex_count(gear->teeth);
+
+		gears[g].first_index = pool->index_count;
+		gears[g].index_count = gear_index_count(gear->teeth);
+		gears[g].vertex_offset = (int32_t)pool->vertex_count;
+
+		gpu_params[g] = (GpuGearParams){.shape = {gear->inner_radius, gear->outer_radius, gear->width, gear->tooth_depth},
+		                                .teeth = (uint32_t)gear->teeth,
+		                                .first_vertex = pool->vertex_count,
+		                                .first_index = pool->index_count,
+		                                .padding = 0};
+
+		pool->vertex_count += mesh_vertices;
+		pool->index_count += gears[g].index_count;
+		max_mesh_vertices = SDL_max(max_mesh_vertices, mesh_vertices);
+		max_teeth = SDL_max(max_teeth, (uint32_t)gear->teeth);
+	}
+
+	pool->index_size = max_mesh_vertices <= 65536 ? sizeof(uint16_t) : sizeof(uint32_t);
+
+	uint32_t vertex_bytes = pool->vertex_count * vertex_size;
+	uint32_t index_bytes = pool->index_count * pool->index_size;
+	uint32_t params_bytes = count * (uint32_t)sizeof(GpuGearParams);
+
+#ifdef _DEBUG
+	printf("Geometry pool (gpu generated): %u vertices (%u bytes), %u %u-bit indices (%u bytes)\n", pool->vertex_count, vertex_bytes, pool->index_count,
+	       pool->index_size * 8, index_bytes);
+#endif
+
+	/* the pool is written by the compute shader, then read as usual by the draws */
+	SDL_GPUBufferCreateInfo vertex_buffer_info = {.usage = SDL_GPU_BUFFERUSAGE_VERTEX | SDL_GPU_BUFFERUSAGE_COMPUTE_STORAGE_WRITE, .size = vertex_bytes, .props = 0};
+
+	SDL_GPUBufferCreateInfo index_buffer_info = {.usage = SDL_GPU_BUFFERUSAGE_INDEX | SDL_GPU_BUFFERUSAGE_COMPUTE_STORAGE_WRITE, .size = index_bytes, .props = 0};
+
+	SDL_GPUBufferCreateInfo params_buffer_info = {.usage = SDL_GPU_BUFFERUSAGE_COMPUTE_STORAGE_READ, .size = params_bytes, .props = 0};
+
+	pool->vertex_buffer = SDL_CreateGPUBuffer(device, &vertex_buffer_info);
+	pool->index_buffer = SDL_CreateGPUBuffer(device, &index_buffer_info);
+	SDL_GPUBuffer *params_buffer = SDL_CreateGPUBuffer(device, &params_buffer_info);
+
+	if (!pool->vertex_buffer || !pool->index_buffer || !params_buffer)
+	{
+		printf("Failed to create GPU buffers\n");
+		if (params_buffer)
+			SDL_ReleaseGPUBuffer(device, params_buffer);
+		free(gpu_params);
+		return false;
+	}
+
+	SDL_GPUComputePipeline *pipeline = create_gen_pipeline(device);
+	if (!pipeline)
+	{
+		printf("Failed to create gear generation pipeline: %s\n", SDL_GetError());
+		SDL_ReleaseGPUBuffer(device, params_buffer);
+		free(gpu_params);
+		return false;
+	}
+
+	SDL_GPUTransferBufferCreateInfo transfer_info = {.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD, .size = params_bytes, .props = 0};
+
+	SDL_GPUTransferBuffer *transfer_buffer = SDL_CreateGPUTransferBuffer(device, &transfer_info);
+	void *mapped = transfer_buffer ? SDL_MapGPUTransferBuffer(device, transfer_buffer, false) : NULL;
+	if (!mapped)
+	{
+		printf("Failed to create transfer buffer: %s\n", SDL_GetError());
+		if (transfer_buffer)
+			SDL_ReleaseGPUTransferBuffer(device, transfer_buffer);
+		SDL_ReleaseGPUComputePipeline(device, pipeline);
+		SDL_ReleaseGPUBuffer(device, params_buffer);
+		free(gpu_params);
+		return false;
+	}
+	memcpy(mapped, gpu_params, params_bytes);
+	SDL_UnmapGPUTransferBuffer(device, transfer_buffer);
+	free(gpu_params);
+
+	trace_begin("create_gears_gpu_dispatch");
+
+	/* upload the parameters and generate every mesh in one submission */
+	SDL_GPUCommandBuffer *gen_cmd = SDL_AcquireGPUCommandBuffer(device);
+
+	SDL_GPUCopyPass *copy_pass = SDL_BeginGPUCopyPass(gen_cmd);
+	SDL_GPUTransferBufferLocation src = {transfer_buffer, 0};
+	SDL_GPUBufferRegion dst = {params_buffer, 0, params_bytes};
+	SDL_UploadToGPUBuffer(copy_pass, &src, &dst, false);
+	SDL_EndGPUCopyPass(copy_pass);
+
+	SDL_GPUStorageBufferReadWriteBinding outputs[2] = {{.buffer = pool->vertex_buffer, .cycle = false}, {.buffer = pool->index_buffer, .cycle = false}};
+	SDL_GPUComputePass *compute_pass = SDL_BeginGPUComputePass(gen_cmd, NULL, 0, outputs, 2);
+	SDL_BindGPUComputePipeline(compute_pass, pipeline);
+	SDL_BindGPUComputeStorageBuffers(compute_pass, 0, &params_buffer, 1);
+
+	GenUniforms uniforms = {.compact_vertices = render_state.vertex_format == VERTEX_COMPACT,
+	                        .short_indices = pool->index_size == sizeof(uint16_t),
+	                        .padding = {0, 0}};
+	SDL_PushGPUComputeUniformData(gen_cmd, 0, &uniforms, sizeof(uniforms));
+
+	/* one thread per tooth, one row of workgroups per gear */
+	SDL_DispatchGPUCompute(compute_pass, (max_teeth + GEN_THREADS - 1) / GEN_THREADS, count, 1);
+	SDL_EndGPUComputePass(compute_pass);
+
+	*gen_fence = SDL_SubmitGPUCommandBufferAndAcquireFence(gen_cmd);
+
+	/* released once the commands are done */
+	SDL_ReleaseGPUTransferBuffer(device, transfer_buffer);
+	SDL_ReleaseGPUBuffer(device, params_buffer);
+	SDL_ReleaseGPUComputePipeline(device, pipeline);
+	trace_end("create_gears_gpu_dispatch");
+
+	if (!*gen_fence)
+	{
+		printf("Failed to submit gear generation: %s\n", SDL_GetError());
+		return false;
+	}
+
+	return true;
+}
+
+static float half_to_float(uint16_t h)
+{
+	uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+	uint32_t exponent = (h >> 10) & 0x1f;
+	uint32_t mantissa = h & 0x3ff;
+
+	float f;
+	if (exponent == 0) /* zero or denormal */
+	{
+		f = ldexpf((float)mantissa, -24);
+		return sign ? -f : f;
+	}
+
+	uint32_t bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+	memcpy(&f, &bits, sizeof(f));
+	return f;
+}
+
+/* the inverse of compact_vertex() in sdlgpu_gear_creation.c */
+static void expand_vertex(const CompactVertex *v, Vertex *out)
+{
+	for (int c = 0; c < 3; c++)
+		out->position[c] = half_to_float(v->position[c]);
+
+	float ox = SDL_max((float)v->normal[0] / 32767.0f, -1.0f);
+	float oy = SDL_max((float)v->normal[1] / 32767.0f, -1.0f);
+	float oz = 1.0f - fabsf(ox) - fabsf(oy);
+	if (oz < 0.0f)
+	{
+		float fx = (1.0f - fabsf(oy)) * (ox >= 0.0f ? 1.0f : -1.0f);
+		float fy = (1.0f - fabsf(ox)) * (oy >= 0.0f ? 1.0f : -1.0f);
+		ox = fx;
+		oy = fy;
+	}
+	float inv_len = 1.0f / sqrtf(ox * ox + oy * oy + oz * oz);
+	out->normal[0] = ox * inv_len;
+	out->normal[1] = oy * inv_len;
+	out->normal[2] = oz * inv_len;
+}
+
+bool verify_gears_gpu(SDL_GPUDevice *device, const GeometryPool *pool, const GearData *gears, const GearParams *params, uint32_t count)
+{
+	uint32_t vertex_size = render_state.vertex_format == VERTEX_COMPACT ? sizeof(CompactVertex) : sizeof(Vertex);
+	uint32_t vertex_bytes = pool->vertex_count * vertex_size;
+	uint32_t index_offset = (vertex_bytes + 3) & ~3u;
+	uint32_t index_bytes = pool->index_count * pool->index_size;
+
+	SDL_GPUTransferBufferCreateInfo transfer_info = {.usage = SDL_GPU_TRANSFERBUFFERUSAGE_DOWNLOAD, .size = index_offset + index_bytes, .props = 0};
+
+	SDL_GPUTransferBuffer *transfer_buffer = SDL_CreateGPUTransferBuffer(device, &transfer_info);
+	if (!transfer_buffer)
+	{
+		printf("Failed to create transfer buffer\n");
+		return false;
+	}
+
+	trace_begin("verify_gears_gpu");
+
+	/* read back the whole pool, laid out like the create_gears() upload */
+	SDL_GPUCommandBuffer *download_cmd = SDL_AcquireGPUCommandBuffer(device);
+	SDL_GPUCopyPass *copy_pass = SDL_BeginGPUCopyPass(download_cmd);
+
+	SDL_GPUBufferRegion src = {pool->vertex_buffer, 0, vertex_bytes};
+	SDL_GPUTransferBufferLocation dst = {transfer_buffer, 0};
+	SDL_DownloadFromGPUBuffer(copy_pass, &src, &dst);
+
+	src = (SDL_GPUBufferRegion){pool->index_buffer, 0, index_bytes};
+	dst.offset = index_offset;
+	SDL_DownloadFromGPUBuffer(copy_pass, &src, &dst);
+
+	SDL_EndGPUCopyPass(copy_pass);
+	SDL_GPUFence *download_fence = SDL_SubmitGPUCommandBufferAndAcquireFence(download_cmd);
+	if (!download_fence)
+	{
+		printf("Failed to submit gear readback: %s\n", SDL_GetError());
+		SDL_ReleaseGPUTransferBuffer(device, transfer_buffer);
+		trace_end("verify_gears_gpu");
+		return false;
+	}
+	SDL_WaitForGPUFences(device, true, &download_fence, 1);
+	SDL_ReleaseGPUFence(device, download_fence);
+
+	const unsigned char *mapped = (const unsigned char *)SDL_MapGPUTransferBuffer(device, transfer_buffer, false);
+	if (!mapped)
+	{
+		printf("Failed to map transfer buffer: %s\n", SDL_GetError());
+		SDL_ReleaseGPUTransferBuffer(device, transfer_buffer);
+		trace_end("verify_gears_gpu");
+		return false;
+	}
+
+	uint32_t max_vertices = 0, max_indices = 0;
+	for (uint32_t g = 0; g < count; g++)
+	{
+		max_vertices = SDL_max(max_vertices, gear_vertex_count(params[g].teeth));
+		max_indices = SDL_max(max_indices, gear_index_count(params[g].teeth));
+	}
+
+	Vertex *vertices = (Vertex *)malloc(max_vertices * sizeof(Vertex));
+	uint32_t *indices = (uint32_t *)malloc(max_indices * sizeof(uint32_t));
+	bool ok = vertices && indices;
+	if (!ok)
+		printf("Failed to allocate reference meshes\n");
+
+	/* keep going after a mismatch, so every gear gets reported */
+	for (uint32_t g = 0; vertices && indices && g < count; g++)
+	{
+		uint32_t mesh_vertices = gear_vertex_count(params[g].teeth);
+		uint32_t vertex_mismatches = 0, index_mismatches = 0;
+		float max_error = 0.0f;
+
+		generate_gear_mesh(&params[g], vertices, indices);
+
+		for (uint32_t v = 0; v < mesh_vertices; v++)
+		{
+			const unsigned char *at = mapped + ((uint32_t)gears[g].vertex_offset + v) * vertex_size;
+			Vertex gpu;
+			if (render_state.vertex_format == VERTEX_COMPACT)
+				expand_vertex((const CompactVertex *)at, &gpu);
+			else
+				memcpy(&gpu, at, sizeof(gpu));
+
+			float error = 0.0f;
+			for (int c = 0; c < 3; c++)
+			{
+				error = SDL_max(error, fabsf(gpu.position[c] - vertices[v].position[c]));
+				error = SDL_max(error, fabsf(gpu.normal[c] - vertices[v].normal[c]));
+			}
+			/* also catches NaN */
+			if (!(error <= VERIFY_TOLERANCE))
+				vertex_mismatches++;
+			else
+				max_error = SDL_max(max_error, error);
+		}
+
+		const unsigned char *gpu_indices = mapped + index_offset + gears[g].first_index * pool->index_size;
+		for (uint32_t i = 0; i < gears[g].index_count; i++)
+		{
+			uint32_t index = pool->index_size == sizeof(uint16_t) ? ((const uint16_t *)gpu_indices)[i] : ((const uint32_t *)gpu_indices)[i];
+			if (index != indices[i])
+				index_mismatches++;
+		}
+
+		printf("Gear %d: gpu mesh max error %g, %u/%u vertices and %u/%u indices mismatched\n", params[g].teeth, (double)max_error, vertex_mismatches,
+		       mesh_vertices, index_mismatches, gears[g].index_count);
+		if (vertex_mismatches || index_mismatches)
+			ok = false;
+	}
+
+	free(vertices);
+	free(indices);
+	SDL_UnmapGPUTransferBuffer(device, transfer_buffer);
+	SDL_ReleaseGPUTransferBuffer(device, transfer_buffer);
+	trace_end("verify_gears_gpu");
+
+	return ok;
+}
@@ -0,0 +1,21 @@
+/*
+ * Copyright (C) 2025 William Horvath
+ */
+
+#pragma once
+#include <stdbool.h>
+
+#include <stdint.h>
+
+typedef struct SDL_GPUDevice SDL_GPUDevice;
+typedef struct SDL_GPUFence SDL_GPUFence;
+typedef struct GearData GearData;
+typedef struct GeometryPool GeometryPool;
+typedef struct GearParams GearParams;
+
+/* like create_gears(), but compute_gears.glsl/hlsl writes the meshes straight into the pool
+ * the meshes keep the raw (unwelded) layout of generate_gear_mesh(), the pool is usable once gen_fence signals */
+bool create_gears_gpu(SDL_GPUDevice *device, GeometryPool *pool, GearData *gears, const GearParams *params, uint32_t count, SDL_GPUFence **gen_fence);
+
+/* read back a pool from create_gears_gpu() and compare it against generate_gear_mesh(), waits for the gpu */
+bool verify_gears_gpu(SDL_GPUDevice *device, const GeometryPool *pool, const GearData *gears, const GearParams *params, uint32_t count);
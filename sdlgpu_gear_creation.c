@@ -3,89 +3,241 @@
  * Copyright (C) 2025       William Horvath   All Rights Reserved.
  */
 
+#include <assert.h>
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <SDL3/SDL_gpu.h>
 
 #include "sdlgpu_gear_creation.h"
+#include "sdlgpu_jobs.h"
 #include "sdlgpu_render.h"
+#include "sdlgpu_trace.h"
 
 #ifndef PI
 #define PI 3.14159265358979323846
 #endif
 
-static inline uint32_t add_vertex(Vertex *vertices, uint32_t *count, float x, float y, float z, float nx, float ny, float nz)
+/* raw gear mesh as generated, before welding */
+typedef struct MeshBuilder
 {
-	uint32_t index = *count;
-	vertices[index].position[0] = x;
-	vertices[index].position[1] = y;
-	vertices[index].position[2] = z;
-	vertices[index].normal[0] = nx;
-	vertices[index].normal[1] = ny;
-	vertices[index].normal[2] = nz;
-	(*count)++;
+	Vertex *vertices;
+	uint32_t *indices;
+	uint32_t vertex_count, max_vertices;
+	uint32_t index_count, max_indices;
+} MeshBuilder;
+
+/* bump allocator for a gear's scratch memory, released with a single free() */
+typedef struct Arena
+{
+	unsigned char *base;
+	size_t size, used;
+} Arena;
+
+#define ARENA_ALIGN(size) (((size) + 15) & ~(size_t)15)
+
+static void *arena_push(Arena *arena, size_t size)
+{
+	size = ARENA_ALIGN(size);
+	assert(arena->used + size <= arena->size);
+
+	void *ptr = arena->base + arena->used;
+	arena->used += size;
+	return ptr;
+}
+
+static inline uint32_t add_vertex(MeshBuilder *mesh, float x, float y, float z, float nx, float ny, float nz)
+{
+	assert(mesh->vertex_count < mesh->max_vertices);
+
+	uint32_t index = mesh->vertex_count++;
+	Vertex *v = &mesh->vertices[index];
+	v->position[0] = x;
+	v->position[1] = y;
+	v->position[2] = z;
+	v->normal[0] = nx;
+	v->normal[1] = ny;
+	v->normal[2] = nz;
 	return index;
 }
 
-static inline void add_triangle(uint32_t *indices, uint32_t *count, uint32_t a, uint32_t b, uint32_t c)
+static inline void add_triangle(MeshBuilder *mesh, uint32_t a, uint32_t b, uint32_t c)
 {
-	indices[(*count)++] = a;
-	indices[(*count)++] = b;
-	indices[(*count)++] = c;
+	assert(mesh->index_count + 3 <= mesh->max_indices);
+
+	mesh->indices[mesh->index_count++] = a;
+	mesh->indices[mesh->index_count++] = b;
+	mesh->indices[mesh->index_count++] = c;
 }
 
-static void create_face(Vertex *vertices, uint32_t *vertex_count, uint32_t *indices, uint32_t *index_count, float inner_radius, float outer_radius, int teeth,
-                        float tooth_depth, float z, float normal_z)
+static inline uint32_t hash_vertex(const Vertex *v)
+{
+	/* FNV-1a over the raw bits, so only exact duplicates are merged */
+	const unsigned char *bytes = (const unsigned char *)v;
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < sizeof(Vertex); i++)
+		hash = (hash ^ bytes[i]) * 16777619u;
+	return hash;
+}
+
+static inline uint32_t weld_table_size(uint32_t vertex_count)
+{
+	uint32_t table_size = 1;
+	while (table_size < vertex_count * 2)
+		table_size <<= 1;
+	return table_size;
+}
+
+/* find vertices with identical position and normal, remap[i] is the welded index of raw vertex i
+ * welded indices are handed out in order of first occurrence, returns how many there are
+ * table is an open-addressed hash of welded index + 1 (0 = empty), and must be zeroed */
+static uint32_t weld_vertices(const Vertex *vertices, uint32_t vertex_count, uint32_t *table, uint32_t table_size, uint32_t *remap)
+{
+	/* the first occurrence of welded vertex n is the raw vertex that got it, remember that for the comparisons */
+	uint32_t welded = 0;
+	for (uint32_t i = 0; i < vertex_count; i++)
+	{
+		uint32_t slot = hash_vertex(&vertices[i]) & (table_size - 1);
+		while (table[slot] && memcmp(&vertices[table[slot] - 1], &vertices[i], sizeof(Vertex)) != 0)
+			slot = (slot + 1) & (table_size - 1);
+
+		if (!table[slot])
+		{
+			table[slot] = i + 1;
+			remap[i] = welded++;
+		}
+		else
+		{
+			remap[i] = remap[table[slot] - 1];
+		}
+	}
+	return welded;
+}
+
+/* round-to-nearest-even float -> half, flushing values below the smallest normal half to zero */
+static uint16_t float_to_half(float f)
+{
+	uint32_t bits;
+	memcpy(&bits, &f, sizeof(bits));
+
+	uint16_t sign = (uint16_t)((bits >> 16) & 0x8000);
+	bits &= 0x7fffffff;
+
+	if (bits >= 0x477fe000) /* clamp to the largest finite half, 65504 */
+		return sign | 0x7bff;
+	if (bits < 0x38800000) /* 2^-14 */
+		return sign;
+
+	bits += 0x00000fff + ((bits >> 13) & 1);
+	return sign | (uint16_t)((bits - 0x38000000) >> 13);
+}
+
+static inline int16_t float_to_snorm16(float f)
+{
+	return (int16_t)lrintf(SDL_clamp(f, -1.0f, 1.0f) * 32767.0f);
+}
+
+static void compact_vertex(const Vertex *v, CompactVertex *out)
+{
+	out->position[0] = float_to_half(v->position[0]);
+	out->position[1] = float_to_half(v->position[1]);
+	out->position[2] = float_to_half(v->position[2]);
+	out->position[3] = 0x3c00; /* 1.0 */
+
+	/* project onto the octahedron |x| + |y| + |z| = 1, folding the lower hemisphere over the diagonals */
+	float inv_l1 = 1.0f / (fabsf(v->normal[0]) + fabsf(v->normal[1]) + fabsf(v->normal[2]));
+	float ox = v->normal[0] * inv_l1;
+	float oy = v->normal[1] * inv_l1;
+	if (v->normal[2] < 0.0f)
+	{
+		float fx = (1.0f - fabsf(oy)) * (ox >= 0.0f ? 1.0f : -1.0f);
+		float fy = (1.0f - fabsf(ox)) * (oy >= 0.0f ? 1.0f : -1.0f);
+		ox = fx;
+		oy = fy;
+	}
+	out->normal[0] = float_to_snorm16(ox);
+	out->normal[1] = float_to_snorm16(oy);
+}
+
+/* write the welded vertices in the given format, raw vertex i goes to remap[i] if it's the first one there */
+static void write_vertices(void *dst, const Vertex *vertices, uint32_t vertex_count, const uint32_t *remap, VertexFormat format)
+{
+	uint32_t next = 0;
+	for (uint32_t i = 0; i < vertex_count; i++)
+	{
+		if (remap[i] != next)
+			continue;
+
+		if (format == VERTEX_COMPACT)
+			compact_vertex(&vertices[i], &((CompactVertex *)dst)[next]);
+		else
+			((Vertex *)dst)[next] = vertices[i];
+		next++;
+	}
+}
+
+static void write_indices(void *dst, const uint32_t *indices, uint32_t index_count, const uint32_t *remap, uint32_t index_size)
+{
+	if (index_size == sizeof(uint16_t))
+	{
+		uint16_t *out = (uint16_t *)dst;
+		for (uint32_t i = 0; i < index_count; i++)
+			out[i] = (uint16_t)remap[indices[i]];
+	}
+	else
+	{
+		uint32_t *out = (uint32_t *)dst;
+		for (uint32_t i = 0; i < index_count; i++)
+			out[i] = remap[indices[i]];
+	}
+}
+
+static void create_face(MeshBuilder *mesh, float inner_radius, float outer_radius, int teeth, float tooth_depth, float z, float normal_z)
 {
 	float r0 = inner_radius;
 	float r1 = outer_radius - tooth_depth / 2.0f;
 	float da = (float)(2.0 * PI / teeth / 4.0);
 
-	/* create main ring face like an OpenGL GL_QUAD_STRIP */
-	uint32_t *ring_vertices = (uint32_t *)malloc((4 * teeth + 4) * sizeof(uint32_t)); /* store vertex indices for triangulation */
-	uint32_t ring_count = 0;
+	/* create main ring face like an OpenGL GL_QUAD_STRIP, the strip's vertices are consecutive */
+	uint32_t first = mesh->vertex_count;
 
 	for (int i = 0; i <= teeth; i++)
 	{
 		float angle = (float)(i * 2.0 * PI / teeth);
 
-		ring_vertices[ring_count++] = add_vertex(vertices, vertex_count, r0 * cosf(angle), r0 * sinf(angle), z, 0, 0, normal_z);
-		ring_vertices[ring_count++] = add_vertex(vertices, vertex_count, r1 * cosf(angle), r1 * sinf(angle), z, 0, 0, normal_z);
+		add_vertex(mesh, r0 * cosf(angle), r0 * sinf(angle), z, 0, 0, normal_z);
+		add_vertex(mesh, r1 * cosf(angle), r1 * sinf(angle), z, 0, 0, normal_z);
 
 		if (i < teeth)
 		{
-			ring_vertices[ring_count++] = add_vertex(vertices, vertex_count, r0 * cosf(angle), r0 * sinf(angle), z, 0, 0, normal_z);
-			ring_vertices[ring_count++] = add_vertex(vertices, vertex_count, r1 * cosf(angle + 3 * da), r1 * sinf(angle + 3 * da), z, 0, 0, normal_z);
+			add_vertex(mesh, r0 * cosf(angle), r0 * sinf(angle), z, 0, 0, normal_z);
+			add_vertex(mesh, r1 * cosf(angle + 3 * da), r1 * sinf(angle + 3 * da), z, 0, 0, normal_z);
 		}
 	}
 
 	/* triangulate the quad strip with proper winding order */
-	for (uint32_t i = 0; i < ring_count - 2; i += 2)
+	for (uint32_t v0 = first; v0 < mesh->vertex_count - 2; v0 += 2)
 	{
-		uint32_t v0 = ring_vertices[i];
-		uint32_t v1 = ring_vertices[i + 1];
-		uint32_t v2 = ring_vertices[i + 2];
-		uint32_t v3 = ring_vertices[i + 3];
+		uint32_t v1 = v0 + 1;
+		uint32_t v2 = v0 + 2;
+		uint32_t v3 = v0 + 3;
 
 		if (normal_z > 0) /* front face */
 		{
-			add_triangle(indices, index_count, v0, v1, v3);
-			add_triangle(indices, index_count, v0, v3, v2);
+			add_triangle(mesh, v0, v1, v3);
+			add_triangle(mesh, v0, v3, v2);
 		}
 		else /* back face */
 		{
-			add_triangle(indices, index_count, v0, v3, v1);
-			add_triangle(indices, index_count, v0, v2, v3);
+			add_triangle(mesh, v0, v3, v1);
+			add_triangle(mesh, v0, v2, v3);
 		}
 	}
-
-	free(ring_vertices);
 }
 
-static void create_tooth_faces(Vertex *vertices, uint32_t *vertex_count, uint32_t *indices, uint32_t *index_count, float outer_radius, int teeth, float tooth_depth,
-                               float z, float normal_z)
+static void create_tooth_faces(MeshBuilder *mesh, float outer_radius, int teeth, float tooth_depth, float z, float normal_z)
 {
 	float r1 = outer_radius - tooth_depth / 2.0f;
 	float r2 = outer_radius + tooth_depth / 2.0f;
@@ -96,63 +248,32 @@ static void create_tooth_faces(Vertex *vertices, uint32_t *vertex_count, uint32_
 		float angle = (float)(i * 2.0 * PI / teeth);
 
 		/* single quad per tooth */
-		uint32_t t0 = add_vertex(vertices, vertex_count, r1 * cosf(angle), r1 * sinf(angle), z, 0, 0, normal_z);
-		uint32_t t1 = add_vertex(vertices, vertex_count, r2 * cosf(angle + da), r2 * sinf(angle + da), z, 0, 0, normal_z);
-		uint32_t t2 = add_vertex(vertices, vertex_count, r2 * cosf(angle + 2 * da), r2 * sinf(angle + 2 * da), z, 0, 0, normal_z);
-		uint32_t t3 = add_vertex(vertices, vertex_count, r1 * cosf(angle + 3 * da), r1 * sinf(angle + 3 * da), z, 0, 0, normal_z);
+		uint32_t t0 = add_vertex(mesh, r1 * cosf(angle), r1 * sinf(angle), z, 0, 0, normal_z);
+		uint32_t t1 = add_vertex(mesh, r2 * cosf(angle + da), r2 * sinf(angle + da), z, 0, 0, normal_z);
+		uint32_t t2 = add_vertex(mesh, r2 * cosf(angle + 2 * da), r2 * sinf(angle + 2 * da), z, 0, 0, normal_z);
+		uint32_t t3 = add_vertex(mesh, r1 * cosf(angle + 3 * da), r1 * sinf(angle + 3 * da), z, 0, 0, normal_z);
 
 		if (normal_z > 0) /* front face */
 		{
-			add_triangle(indices, index_count, t0, t1, t2);
-			add_triangle(indices, index_count, t0, t2, t3);
+			add_triangle(mesh, t0, t1, t2);
+			add_triangle(mesh, t0, t2, t3);
 		}
 		else /* back face */
 		{
-			add_triangle(indices, index_count, t0, t2, t1);
-			add_triangle(indices, index_count, t0, t3, t2);
+			add_triangle(mesh, t0, t2, t1);
+			add_triangle(mesh, t0, t3, t2);
 		}
 	}
 }
 
-bool create_gear(SDL_GPUDevice *device, GearData *gear_data, float inner_radius, float outer_radius, float width, int teeth, float tooth_depth, const float color[3])
+static void create_outer_strip(MeshBuilder *mesh, float outer_radius, float width, int teeth, float tooth_depth)
 {
-	float r0 = inner_radius;
 	float r1 = outer_radius - tooth_depth / 2.0f;
 	float r2 = outer_radius + tooth_depth / 2.0f;
 	float da = (float)(2.0 * PI / teeth / 4.0);
 
-	/* estimate max vertices and indices needed */
-	int max_vertices = teeth * 100 + 200;
-	int max_indices = teeth * 300 + 600;
-
-	Vertex *vertices = (Vertex *)malloc(max_vertices * sizeof(Vertex));
-	uint32_t *indices = (uint32_t *)malloc(max_indices * sizeof(uint32_t));
-
-	if (!vertices || !indices)
-	{
-		free(vertices);
-		free(indices);
-		return false;
-	}
-
-	uint32_t vertex_count = 0;
-	uint32_t index_count = 0;
-
-	/* create front face - main ring */
-	create_face(vertices, &vertex_count, indices, &index_count, inner_radius, outer_radius, teeth, tooth_depth, width * 0.5f, 1.0f);
-
-	/* create front sides of teeth */
-	create_tooth_faces(vertices, &vertex_count, indices, &index_count, outer_radius, teeth, tooth_depth, width * 0.5f, 1.0f);
-
-	/* create back face - main ring */
-	create_face(vertices, &vertex_count, indices, &index_count, inner_radius, outer_radius, teeth, tooth_depth, -width * 0.5f, -1.0f);
-
-	/* create back sides of teeth */
-	create_tooth_faces(vertices, &vertex_count, indices, &index_count, outer_radius, teeth, tooth_depth, -width * 0.5f, -1.0f);
-
-	/* create outward faces of teeth, like an OpenGL GL_QUAD_STRIP */
-	uint32_t *strip_vertices = (uint32_t *)malloc((8 * teeth + 2) * sizeof(uint32_t)); /* vertices for the quad strip */
-	uint32_t strip_count = 0;
+	/* create outward faces of teeth, like an OpenGL GL_QUAD_STRIP, the strip's vertices are consecutive */
+	uint32_t first = mesh->vertex_count;
 
 	for (int i = 0; i < teeth; i++)
 	{
@@ -161,8 +282,8 @@ bool create_gear(SDL_GPUDevice *device, GearData *gear_data, float inner_radius,
 		/* first edge vertices get the radial normal from previous iteration */
 		float radial_nx = cosf(angle);
 		float radial_ny = sinf(angle);
-		strip_vertices[strip_count++] = add_vertex(vertices, &vertex_count, r1 * cosf(angle), r1 * sinf(angle), width * 0.5f, radial_nx, radial_ny, 0);
-		strip_vertices[strip_count++] = add_vertex(vertices, &vertex_count, r1 * cosf(angle), r1 * sinf(angle), -width * 0.5f, radial_nx, radial_ny, 0);
+		add_vertex(mesh, r1 * cosf(angle), r1 * sinf(angle), width * 0.5f, radial_nx, radial_ny, 0);
+		add_vertex(mesh, r1 * cosf(angle), r1 * sinf(angle), -width * 0.5f, radial_nx, radial_ny, 0);
 
 		/* calculate normal for first slanted face */
 		float u = r2 * cosf(angle + da) - r1 * cosf(angle);
@@ -172,14 +293,12 @@ bool create_gear(SDL_GPUDevice *device, GearData *gear_data, float inner_radius,
 		float slant1_ny = -u / len;
 
 		/* vertices at angle+da get the slanted normal */
-		strip_vertices[strip_count++] = add_vertex(vertices, &vertex_count, r2 * cosf(angle + da), r2 * sinf(angle + da), width * 0.5f, slant1_nx, slant1_ny, 0);
-		strip_vertices[strip_count++] = add_vertex(vertices, &vertex_count, r2 * cosf(angle + da), r2 * sinf(angle + da), -width * 0.5f, slant1_nx, slant1_ny, 0);
+		add_vertex(mesh, r2 * cosf(angle + da), r2 * sinf(angle + da), width * 0.5f, slant1_nx, slant1_ny, 0);
+		add_vertex(mesh, r2 * cosf(angle + da), r2 * sinf(angle + da), -width * 0.5f, slant1_nx, slant1_ny, 0);
 
 		/* vertices at angle+2*da get the radial normal */
-		strip_vertices[strip_count++] =
-		    add_vertex(vertices, &vertex_count, r2 * cosf(angle + 2 * da), r2 * sinf(angle + 2 * da), width * 0.5f, radial_nx, radial_ny, 0);
-		strip_vertices[strip_count++] =
-		    add_vertex(vertices, &vertex_count, r2 * cosf(angle + 2 * da), r2 * sinf(angle + 2 * da), -width * 0.5f, radial_nx, radial_ny, 0);
+		add_vertex(mesh, r2 * cosf(angle + 2 * da), r2 * sinf(angle + 2 * da), width * 0.5f, radial_nx, radial_ny, 0);
+		add_vertex(mesh, r2 * cosf(angle + 2 * da), r2 * sinf(angle + 2 * da), -width * 0.5f, radial_nx, radial_ny, 0);
 
 		/* calculate normal for second slanted face */
 		u = r1 * cosf(angle + 3 * da) - r2 * cosf(angle + 2 * da);
@@ -189,116 +308,304 @@ bool create_gear(SDL_GPUDevice *device, GearData *gear_data, float inner_radius,
 		float slant2_ny = -u / len;
 
 		/* vertices at angle+3*da get the second slanted normal */
-		strip_vertices[strip_count++] =
-		    add_vertex(vertices, &vertex_count, r1 * cosf(angle + 3 * da), r1 * sinf(angle + 3 * da), width * 0.5f, slant2_nx, slant2_ny, 0);
-		strip_vertices[strip_count++] =
-		    add_vertex(vertices, &vertex_count, r1 * cosf(angle + 3 * da), r1 * sinf(angle + 3 * da), -width * 0.5f, slant2_nx, slant2_ny, 0);
+		add_vertex(mesh, r1 * cosf(angle + 3 * da), r1 * sinf(angle + 3 * da), width * 0.5f, slant2_nx, slant2_ny, 0);
+		add_vertex(mesh, r1 * cosf(angle + 3 * da), r1 * sinf(angle + 3 * da), -width * 0.5f, slant2_nx, slant2_ny, 0);
 	}
 
 	/* close the strip - vertices at angle 0 get radial normal */
-	strip_vertices[strip_count++] = add_vertex(vertices, &vertex_count, r1 * cosf(0), r1 * sinf(0), width * 0.5f, 1.0f, 0.0f, 0);
-	strip_vertices[strip_count++] = add_vertex(vertices, &vertex_count, r1 * cosf(0), r1 * sinf(0), -width * 0.5f, 1.0f, 0.0f, 0);
+	add_vertex(mesh, r1 * cosf(0), r1 * sinf(0), width * 0.5f, 1.0f, 0.0f, 0);
+	add_vertex(mesh, r1 * cosf(0), r1 * sinf(0), -width * 0.5f, 1.0f, 0.0f, 0);
 
 	/* triangulate the quad strip */
-	for (uint32_t i = 0; i < strip_count - 2; i += 2)
+	for (uint32_t v0 = first; v0 < mesh->vertex_count - 2; v0 += 2)
 	{
-		uint32_t v0 = strip_vertices[i];
-		uint32_t v1 = strip_vertices[i + 1];
-		uint32_t v2 = strip_vertices[i + 2];
-		uint32_t v3 = strip_vertices[i + 3];
+		uint32_t v1 = v0 + 1;
+		uint32_t v2 = v0 + 2;
+		uint32_t v3 = v0 + 3;
 
 		/* create quad as two triangles */
-		add_triangle(indices, &index_count, v0, v1, v3);
-		add_triangle(indices, &index_count, v0, v3, v2);
+		add_triangle(mesh, v0, v1, v3);
+		add_triangle(mesh, v0, v3, v2);
 	}
+}
+
+static void create_inner_cylinder(MeshBuilder *mesh, float inner_radius, float width, int teeth)
+{
+	float r0 = inner_radius;
 
-	/* create inside radius cylinder */
 	for (int i = 0; i < teeth; i++)
 	{
 		float angle = (float)(i * 2.0 * PI / teeth);
 		float next_angle = (float)((i + 1) * 2.0 * PI / teeth);
 
 		/* normals pointing inward (toward axis) */
-		uint32_t c0 = add_vertex(vertices, &vertex_count, r0 * cosf(angle), r0 * sinf(angle), -width * 0.5f, -cosf(angle), -sinf(angle), 0);
-		uint32_t c1 = add_vertex(vertices, &vertex_count, r0 * cosf(angle), r0 * sinf(angle), width * 0.5f, -cosf(angle), -sinf(angle), 0);
-		uint32_t c2 = add_vertex(vertices, &vertex_count, r0 * cosf(next_angle), r0 * sinf(next_angle), width * 0.5f, -cosf(next_angle), -sinf(next_angle), 0);
-		uint32_t c3 = add_vertex(vertices, &vertex_count, r0 * cosf(next_angle), r0 * sinf(next_angle), -width * 0.5f, -cosf(next_angle), -sinf(next_angle), 0);
+		uint32_t c0 = add_vertex(mesh, r0 * cosf(angle), r0 * sinf(angle), -width * 0.5f, -cosf(angle), -sinf(angle), 0);
+		uint32_t c1 = add_vertex(mesh, r0 * cosf(angle), r0 * sinf(angle), width * 0.5f, -cosf(angle), -sinf(angle), 0);
+		uint32_t c2 = add_vertex(mesh, r0 * cosf(next_angle), r0 * sinf(next_angle), width * 0.5f, -cosf(next_angle), -sinf(next_angle), 0);
+		uint32_t c3 = add_vertex(mesh, r0 * cosf(next_angle), r0 * sinf(next_angle), -width * 0.5f, -cosf(next_angle), -sinf(next_angle), 0);
 
 		/* winding order for inside faces (viewed from outside) */
-		add_triangle(indices, &index_count, c0, c1, c2);
-		add_triangle(indices, &index_count, c0, c2, c3);
+		add_triangle(mesh, c0, c1, c2);
+		add_triangle(mesh, c0, c2, c3);
 	}
+}
+
+float gear_bounding_radius(const GearParams *gear)
+{
+	/* teeth reach out to outer_radius + tooth_depth / 2, the faces are width / 2 from the origin */
+	float r = gear->outer_radius + gear->tooth_depth / 2.0f;
+	float half_width = gear->width / 2.0f;
+	return sqrtf(r * r + half_width * half_width);
+}
+
+void generate_gear_mesh(const GearParams *gear, Vertex *vertices, uint32_t *indices)
+{
+	MeshBuilder mesh = {.vertices = vertices,
+	                    .indices = indices,
+	                    .vertex_count = 0,
+	                    .max_vertices = gear_vertex_count(gear->teeth),
+	                    .index_count = 0,
+	                    .max_indices = gear_index_count(gear->teeth)};
+
+	/* create front face - main ring */
+	create_face(&mesh, gear->inner_radius, gear->outer_radius, gear->teeth, gear->tooth_depth, gear->width * 0.5f, 1.0f);
+
+	/* create front sides of teeth */
+	create_tooth_faces(&mesh, gear->outer_radius, gear->teeth, gear->tooth_depth, gear->width * 0.5f, 1.0f);
+
+	/* create back face - main ring */
+	create_face(&mesh, gear->inner_radius, gear->outer_radius, gear->teeth, gear->tooth_depth, -gear->width * 0.5f, -1.0f);
+
+	/* create back sides of teeth */
+	create_tooth_faces(&mesh, gear->outer_radius, gear->teeth, gear->tooth_depth, -gear->width * 0.5f, -1.0f);
+
+	create_outer_strip(&mesh, gear->outer_radius, gear->width, gear->teeth, gear->tooth_depth);
+	create_inner_cylinder(&mesh, gear->inner_radius, gear->width, gear->teeth);
+
+	assert(mesh.vertex_count == mesh.max_vertices && mesh.index_count == mesh.max_indices);
+}
+
+/* one gear of a create_gears() batch, between generation and upload */
+typedef struct PendingMesh
+{
+	Vertex *vertices; /* raw, gear_vertex_count() of them */
+	uint32_t *indices;
+	uint32_t *remap;
+	uint32_t vertex_count; /* after welding */
+} PendingMesh;
+
+/* shared by the jobs of one create_gears() phase */
+typedef struct GenBatch
+{
+	const GearParams *params;
+	PendingMesh *pending;
+	uint32_t *tables; /* a weld table per job thread, sized for the largest mesh */
+	uint32_t table_size;
+
+	/* packing phase only */
+	const GearData *gears;
+	unsigned char *mapped;
+	uint32_t index_offset;
+	uint32_t index_size;
+	uint32_t vertex_size;
+} GenBatch;
+
+/* generate and weld gears into their preallocated regions */
+static void generate_job(void *data, uint32_t first, uint32_t count, unsigned int worker)
+{
+	GenBatch *batch = (GenBatch *)data;
+	uint32_t *table = batch->tables + (size_t)worker * batch->table_size;
+
+	trace_begin("create_gears_generate");
+	for (uint32_t g = first; g < first + count; g++)
+	{
+		const GearParams *gear = &batch->params[g];
+		PendingMesh *pm = &batch->pending[g];
+		uint32_t max_vertices = gear_vertex_count(gear->teeth);
+
+		generate_gear_mesh(gear, pm->vertices, pm->indices);
+
+		/* the mesh emits the same point more than once (e.g. shared ring/tooth corners), merge those */
+		uint32_t gear_table_size = weld_table_size(max_vertices);
+		memset(table, 0, gear_table_size * sizeof(uint32_t));
+		pm->vertex_count = weld_vertices(pm->vertices, max_vertices, table, gear_table_size, pm->remap);
+	}
+	trace_end("create_gears_generate");
+}
+
+/* write welded gears into their place in the mapped transfer buffer */
+static void pack_job(void *data, uint32_t first, uint32_t count, unsigned int worker)
+{
+	(void)worker;
+	GenBatch *batch = (GenBatch *)data;
+
+	trace_begin("create_gears_pack");
+	for (uint32_t g = first; g < first + count; g++)
+	{
+		const PendingMesh *pm = &batch->pending[g];
+		const GearData *gear = &batch->gears[g];
+		write_vertices(batch->mapped + (uint32_t)gear->vertex_offset * batch->vertex_size, pm->vertices, gear_vertex_count(batch->params[g].teeth), pm->remap,
+		               render_state.vertex_format);
+		write_indices(batch->mapped + batch->index_offset + gear->first_index * batch->index_size, pm->indices, gear->index_count, pm->remap,
+		              batch->index_size);
+	}
+	trace_end("create_gears_pack");
+}
+
+bool create_gears(SDL_GPUDevice *device, GeometryPool *pool, GearData *gears, const GearParams *params, uint32_t count, SDL_GPUFence **upload_fence)
+{
+	*upload_fence = NULL;
+
+	uint32_t num_tables = jobs_thread_count();
+
+	/* all scratch memory for the batch: the pending meshes, each one's raw vertices, raw indices and remap, and a weld table per job thread sized for
+	 * the largest mesh */
+	size_t arena_size = ARENA_ALIGN(count * sizeof(PendingMesh));
+	uint32_t table_size = 0;
+	for (uint32_t g = 0; g < count; g++)
+	{
+		uint32_t max_vertices = gear_vertex_count(params[g].teeth);
+		arena_size += ARENA_ALIGN(max_vertices * sizeof(Vertex)) + ARENA_ALIGN(gear_index_count(params[g].teeth) * sizeof(uint32_t)) +
+		              ARENA_ALIGN(max_vertices * sizeof(uint32_t));
+		table_size = SDL_max(table_size, weld_table_size(max_vertices));
+	}
+	arena_size += ARENA_ALIGN(num_tables * table_size * sizeof(uint32_t));
+
+	Arena arena = {.base = (unsigned char *)malloc(arena_size), .size = arena_size, .used = 0};
+	if (!arena.base)
+		return false;
+
+	PendingMesh *pending = (PendingMesh *)arena_push(&arena, count * sizeof(PendingMesh));
+	for (uint32_t g = 0; g < count; g++)
+	{
+		uint32_t max_vertices = gear_vertex_count(params[g].teeth);
+		pending[g].vertices = (Vertex *)arena_push(&arena, max_vertices * sizeof(Vertex));
+		pending[g].indices = (uint32_t *)arena_push(&arena, gear_index_count(params[g].teeth) * sizeof(uint32_t));
+		pending[g].remap = (uint32_t *)arena_push(&arena, max_vertices * sizeof(uint32_t));
+	}
+
+	GenBatch batch = {.params = params,
+	                  .pending = pending,
+	                  .tables = (uint32_t *)arena_push(&arena, num_tables * table_size * sizeof(uint32_t)),
+	                  .table_size = table_size};
+
+	/* the meshes are independent, so they're spread over the job threads one gear at a time */
+	jobs_parallel_for(count, 1, generate_job, &batch);
+
+	uint32_t vertex_size = render_state.vertex_format == VERTEX_COMPACT ? sizeof(CompactVertex) : sizeof(Vertex);
+	uint32_t max_mesh_vertices = 0;
+
+	pool->vertex_count = 0;
+	pool->index_count = 0;
+
+	for (uint32_t g = 0; g < count; g++)
+	{
+		const PendingMesh *pm = &pending[g];
+		uint32_t max_indices = gear_index_count(params[g].teeth);
+
+		/* meshes are packed back to back in the pool, indices stay relative to their mesh */
+		gears[g].first_index = pool->index_count;
+		gears[g].index_count = max_indices;
+		gears[g].vertex_offset = (int32_t)pool->vertex_count;
+
+		pool->vertex_count += pm->vertex_count;
+		pool->index_count += max_indices;
+		max_mesh_vertices = SDL_max(max_mesh_vertices, pm->vertex_count);
+
+#ifdef _DEBUG
+		printf("Gear %d: Generated %u vertices (%u after welding, %u bytes each), %u indices\n", params[g].teeth, gear_vertex_count(params[g].teeth),
+		       pm->vertex_count, vertex_size, max_indices);
+#endif
+	}
+
+	/* the index buffer is bound once for every mesh, so they all share the element size */
+	pool->index_size = max_mesh_vertices <= 65536 ? sizeof(uint16_t) : sizeof(uint32_t);
+
+	uint32_t vertex_bytes = pool->vertex_count * vertex_size;
+	uint32_t index_bytes = pool->index_count * pool->index_size;
 
 #ifdef _DEBUG
-	printf("Gear %d: Generated %u vertices, %u indices\n", teeth, vertex_count, index_count);
+	printf("Geometry pool: %u vertices (%u bytes), %u %u-bit indices (%u bytes)\n", pool->vertex_count, vertex_bytes, pool->index_count, pool->index_size * 8,
+	       index_bytes);
 #endif
 
 	/* create GPU buffers */
-	SDL_GPUBufferCreateInfo vertex_buffer_info = {.usage = SDL_GPU_BUFFERUSAGE_VERTEX, .size = (uint32_t)(vertex_count * sizeof(Vertex)), .props = 0};
+	SDL_GPUBufferCreateInfo vertex_buffer_info = {.usage = SDL_GPU_BUFFERUSAGE_VERTEX, .size = vertex_bytes, .props = 0};
 
-	SDL_GPUBufferCreateInfo index_buffer_info = {.usage = SDL_GPU_BUFFERUSAGE_INDEX, .size = (uint32_t)(index_count * sizeof(uint32_t)), .props = 0};
+	SDL_GPUBufferCreateInfo index_buffer_info = {.usage = SDL_GPU_BUFFERUSAGE_INDEX, .size = index_bytes, .props = 0};
 
-	gear_data->vertex_buffer = SDL_CreateGPUBuffer(device, &vertex_buffer_info);
-	gear_data->index_buffer = SDL_CreateGPUBuffer(device, &index_buffer_info);
-	gear_data->index_count = index_count;
-	gear_data->color[0] = color[0];
-	gear_data->color[1] = color[1];
-	gear_data->color[2] = color[2];
+	pool->vertex_buffer = SDL_CreateGPUBuffer(device, &vertex_buffer_info);
+	pool->index_buffer = SDL_CreateGPUBuffer(device, &index_buffer_info);
 
-	if (!gear_data->vertex_buffer || !gear_data->index_buffer)
+	if (!pool->vertex_buffer || !pool->index_buffer)
 	{
 		printf("Failed to create GPU buffers\n");
-		free(vertices);
-		free(indices);
-		free(strip_vertices);
+		free(arena.base);
 		return false;
 	}
 
-	/* upload data */
-	SDL_GPUTransferBufferCreateInfo transfer_info = {.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
-	                                                 .size = SDL_max((uint32_t)(vertex_count * sizeof(Vertex)), (uint32_t)(index_count * sizeof(uint32_t))),
-	                                                 .props = 0};
+	/* upload data, the transfer buffer mirrors the pool: all vertices, then all indices from the next 4-byte boundary */
+	uint32_t index_offset = (vertex_bytes + 3) & ~3u;
+	SDL_GPUTransferBufferCreateInfo transfer_info = {.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD, .size = index_offset + index_bytes, .props = 0};
 
 	SDL_GPUTransferBuffer *transfer_buffer = SDL_CreateGPUTransferBuffer(device, &transfer_info);
 	if (!transfer_buffer)
 	{
 		printf("Failed to create transfer buffer\n");
-		free(vertices);
-		free(indices);
-		free(strip_vertices);
+		free(arena.base);
 		return false;
 	}
 
+	trace_begin("create_gears_upload");
+
+	/* the welded meshes are written straight into the mapped transfer buffer, there's no intermediate copy */
+	unsigned char *mapped = (unsigned char *)SDL_MapGPUTransferBuffer(device, transfer_buffer, false);
+	if (!mapped)
+	{
+		printf("Failed to map transfer buffer: %s\n", SDL_GetError());
+		SDL_ReleaseGPUTransferBuffer(device, transfer_buffer);
+		free(arena.base);
+		trace_end("create_gears_upload");
+		return false;
+	}
+	batch.gears = gears;
+	batch.mapped = mapped;
+	batch.index_offset = index_offset;
+	batch.index_size = pool->index_size;
+	batch.vertex_size = vertex_size;
+	jobs_parallel_for(count, 1, pack_job, &batch);
+	SDL_UnmapGPUTransferBuffer(device, transfer_buffer);
+
+	/* one copy pass and one submission for the whole pool */
 	SDL_GPUCommandBuffer *upload_cmd = SDL_AcquireGPUCommandBuffer(device);
 	SDL_GPUCopyPass *copy_pass = SDL_BeginGPUCopyPass(upload_cmd);
 
 	/* upload vertices */
-	void *mapped = SDL_MapGPUTransferBuffer(device, transfer_buffer, false);
-	memcpy(mapped, vertices, vertex_count * sizeof(Vertex));
-	SDL_UnmapGPUTransferBuffer(device, transfer_buffer);
-
 	SDL_GPUTransferBufferLocation src = {transfer_buffer, 0};
-	SDL_GPUBufferRegion dst = {gear_data->vertex_buffer, 0, (uint32_t)(vertex_count * sizeof(Vertex))};
+	SDL_GPUBufferRegion dst = {pool->vertex_buffer, 0, vertex_bytes};
 	SDL_UploadToGPUBuffer(copy_pass, &src, &dst, false);
 
 	/* upload indices */
-	mapped = SDL_MapGPUTransferBuffer(device, transfer_buffer, true);
-	memcpy(mapped, indices, index_count * sizeof(uint32_t));
-	SDL_UnmapGPUTransferBuffer(device, transfer_buffer);
-
-	src.offset = 0;
-	dst.buffer = gear_data->index_buffer;
+	src.offset = index_offset;
+	dst.buffer = pool->index_buffer;
 	dst.offset = 0;
-	dst.size = index_count * sizeof(uint32_t);
+	dst.size = index_bytes;
 	SDL_UploadToGPUBuffer(copy_pass, &src, &dst, false);
 
 	SDL_EndGPUCopyPass(copy_pass);
-	SDL_SubmitGPUCommandBuffer(upload_cmd);
+	*upload_fence = SDL_SubmitGPUCommandBufferAndAcquireFence(upload_cmd);
 
+	/* released once the copy is done */
 	SDL_ReleaseGPUTransferBuffer(device, transfer_buffer);
-	free(vertices);
-	free(indices);
-	free(strip_vertices);
+	trace_end("create_gears_upload");
+
+	free(arena.base);
+
+	if (!*upload_fence)
+	{
+		printf("Failed to submit gear upload: %s\n", SDL_GetError());
+		return false;
+	}
 
 	return true;
 }
@@ -5,9 +5,34 @@
 #pragma once
 #include <stdbool.h>
 
+#include <stdint.h>
+
 typedef struct SDL_GPUDevice SDL_GPUDevice;
+typedef struct SDL_GPUFence SDL_GPUFence;
 typedef struct GearData GearData;
+typedef struct GeometryPool GeometryPool;
+
+typedef struct GearParams GearParams;
+typedef struct Vertex Vertex;
+
+/* exact vertex and index counts of a gear mesh before welding (vertex_procedural.glsl/hlsl draws the same triangles):
+ * 2x face ring (4t+2 vertices, 12t indices), 2x tooth faces (4t, 6t), outer strip (8t+2, 24t), inner cylinder (4t, 6t) */
+static inline uint32_t gear_vertex_count(int teeth)
+{
+	return 28u * (uint32_t)teeth + 6u;
+}
+
+static inline uint32_t gear_index_count(int teeth)
+{
+	return 66u * (uint32_t)teeth;
+}
+
+/* radius of a sphere around the gear's origin that holds the whole mesh, for culling */
+float gear_bounding_radius(const GearParams *gear);
+
+/* the raw (unwelded) mesh of one gear, into gear_vertex_count() vertices and gear_index_count() indices */
+void generate_gear_mesh(const GearParams *gear, Vertex *vertices, uint32_t *indices);
 
-/* build a gear with some adjustable parameters */
-bool create_gear(SDL_GPUDevice *device, GearData *gear_data, float inner_radius, float outer_radius, float width, int teeth, float tooth_depth,
-                 const float color[3]);
+/* build count gears into a new geometry pool, uploading them through one transfer buffer and one command buffer
+ * the pool is usable once upload_fence signals, the caller releases it */
+bool create_gears(SDL_GPUDevice *device, GeometryPool *pool, GearData *gears, const GearParams *params, uint32_t count, SDL_GPUFence **upload_fence);
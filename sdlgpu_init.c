@@ -7,10 +7,14 @@
 
 #include <SDL3/SDL_gpu.h>
 
-#include "sdlgpu_gear_creation.h"
+#include "sdlgpu_culling.h"
+#include "sdlgpu_frames.h"
 #include "sdlgpu_init.h"
 #include "sdlgpu_render.h"
+#include "sdlgpu_scene.h"
 #include "sdlgpu_shader_data.h"
+#include "sdlgpu_spatial.h"
+#include "sdlgpu_targets.h"
 
 #ifdef __cplusplus
 #define Z_INIT \
@@ -29,6 +33,9 @@
 #define SHADER_DEBUG_VAL false
 #endif
 
+/* color format of the headless render target, universally supported as a color target */
+#define OFFSCREEN_FORMAT SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM
+
 static int init_with_retry(InitParams *usercfg);
 bool init_gpu(InitParams *usercfg)
 {
@@ -48,16 +55,14 @@ void cleanup_gpu(void)
 {
 	if (render_state.device)
 	{
-		for (int i = 0; i < 3; i++)
-		{
-			if (render_state.gears[i].vertex_buffer)
-				SDL_ReleaseGPUBuffer(render_state.device, render_state.gears[i].vertex_buffer);
-			if (render_state.gears[i].index_buffer)
-				SDL_ReleaseGPUBuffer(render_state.device, render_state.gears[i].index_buffer);
-		}
-
-		if (render_state.depth_texture)
-			SDL_ReleaseGPUTexture(render_state.device, render_state.depth_texture);
+		destroy_frame_resources(render_state.device);
+		destroy_render_targets(render_state.device);
+		spatial_destroy();
+		destroy_culling(render_state.device);
+		destroy_scene(render_state.device);
+
+		if (render_state.offscreen_texture)
+			SDL_ReleaseGPUTexture(render_state.device, render_state.offscreen_texture);
 		if (render_state.pipeline)
 			SDL_ReleaseGPUGraphicsPipeline(render_state.device, render_state.pipeline);
 		if (render_state.vertex_shader)
@@ -71,7 +76,6 @@ void cleanup_gpu(void)
 	memset(&render_state, 0, sizeof(render_state));
 }
 
-static void set_swapchain_params(SDL_Window *window, enum PresentMode *present_mode, unsigned int *image_count);
 static Renderer get_actual_renderer(Renderer choice, bool print_driver_enumeration);
 static int init_with_retry(InitParams *usercfg)
 {
@@ -94,14 +98,32 @@ static int init_with_retry(InitParams *usercfg)
 	const unsigned char *fsh = NULL;
 	unsigned long long fsh_size = 0;
 
+	bool indirect = (usercfg->render_mode == RENDER_INDIRECT);
+	bool instanced = (usercfg->render_mode == RENDER_INSTANCED) || indirect; /* same shaders and vertex layout */
+	bool procedural = (usercfg->render_mode == RENDER_PROCEDURAL);
+	bool compact = (usercfg->vertex_format == VERTEX_COMPACT);
+
 	if (actual_renderer == VULKAN)
 	{
 		SDL_SetStringProperty(props, SDL_PROP_GPU_DEVICE_CREATE_NAME_STRING, "vulkan");
 		SDL_SetBooleanProperty(props, SDL_PROP_GPU_DEVICE_CREATE_SHADERS_SPIRV_BOOLEAN, true);
 
 		shader_format = SDL_GPU_SHADERFORMAT_SPIRV;
-		vsh = vsh_spv;
-		vsh_size = vsh_spv_size();
+		if (procedural)
+		{
+			vsh = vsh_proc_spv;
+			vsh_size = vsh_proc_spv_size();
+		}
+		else if (compact)
+		{
+			vsh = instanced ? vsh_inst_compact_spv : vsh_compact_spv;
+			vsh_size = instanced ? vsh_inst_compact_spv_size() : vsh_compact_spv_size();
+		}
+		else
+		{
+			vsh = instanced ? vsh_inst_spv : vsh_spv;
+			vsh_size = instanced ? vsh_inst_spv_size() : vsh_spv_size();
+		}
 		fsh = fsh_spv;
 		fsh_size = fsh_spv_size();
 	}
@@ -111,8 +133,21 @@ static int init_with_retry(InitParams *usercfg)
 		SDL_SetBooleanProperty(props, SDL_PROP_GPU_DEVICE_CREATE_SHADERS_DXIL_BOOLEAN, true);
 
 		shader_format = SDL_GPU_SHADERFORMAT_DXIL;
-		vsh = vsh_dx;
-		vsh_size = vsh_dx_size();
+		if (procedural)
+		{
+			vsh = vsh_proc_dx;
+			vsh_size = vsh_proc_dx_size();
+		}
+		else if (compact)
+		{
+			vsh = instanced ? vsh_inst_compact_dx : vsh_compact_dx;
+			vsh_size = instanced ? vsh_inst_compact_dx_size() : vsh_compact_dx_size();
+		}
+		else
+		{
+			vsh = instanced ? vsh_inst_dx : vsh_dx;
+			vsh_size = instanced ? vsh_inst_dx_size() : vsh_dx_size();
+		}
 		fsh = fsh_dx;
 		fsh_size = fsh_dx_size();
 	}
@@ -129,7 +164,7 @@ static int init_with_retry(InitParams *usercfg)
 	}
 
 	/* claim window for GPU rendering */
-	if (!SDL_ClaimWindowForGPUDevice(render_state.device, usercfg->window))
+	if (usercfg->window && !SDL_ClaimWindowForGPUDevice(render_state.device, usercfg->window))
 	{
 		printf("Failed to claim window for GPU device: %s\n", SDL_GetError());
 		return 0;
@@ -144,7 +179,7 @@ static int init_with_retry(InitParams *usercfg)
 	                                              .num_samplers = 0,
 	                                              .num_storage_textures = 0,
 	                                              .num_storage_buffers = 0,
-	                                              .num_uniform_buffers = 1,
+	                                              .num_uniform_buffers = (instanced || procedural) ? 1 : 2, /* vertex.glsl/hlsl: per frame + per draw */
 	                                              .props = 0};
 
 	SDL_GPUShaderCreateInfo fragment_shader_info = {.code_size = fsh_size,
@@ -168,16 +203,52 @@ static int init_with_retry(InitParams *usercfg)
 	}
 
 	/* create graphics pipeline */
-	SDL_GPUVertexAttribute vertex_attributes[2] = {{.location = 0, .buffer_slot = 0, .format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3, .offset = 0},
-	                                               {.location = 1, .buffer_slot = 0, .format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3, .offset = 12}};
+	/* slot 0 is the gear mesh, slot 1 is only used by the instanced path (see InstanceData) */
+	/* the first two attributes are swapped for the CompactVertex layout below */
+	SDL_GPUVertexAttribute vertex_attributes[10] = {
+	    {.location = 0, .buffer_slot = 0, .format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3, .offset = 0},
+	    {.location = 1, .buffer_slot = 0, .format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3, .offset = 12},
+	    {.location = 2, .buffer_slot = 1, .format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT4, .offset = 0},   /* mvp_matrix column 0 */
+	    {.location = 3, .buffer_slot = 1, .format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT4, .offset = 16},  /* mvp_matrix column 1 */
+	    {.location = 4, .buffer_slot = 1, .format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT4, .offset = 32},  /* mvp_matrix column 2 */
+	    {.location = 5, .buffer_slot = 1, .format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT4, .offset = 48},  /* mvp_matrix column 3 */
+	    {.location = 6, .buffer_slot = 1, .format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT4, .offset = 64},  /* normal_matrix column 0 */
+	    {.location = 7, .buffer_slot = 1, .format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT4, .offset = 80},  /* normal_matrix column 1 */
+	    {.location = 8, .buffer_slot = 1, .format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT4, .offset = 96},  /* normal_matrix column 2 */
+	    {.location = 9, .buffer_slot = 1, .format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT4, .offset = 112}, /* color */
+	};
+
+	if (compact)
+	{
+		vertex_attributes[0].format = SDL_GPU_VERTEXELEMENTFORMAT_HALF4;
+		vertex_attributes[1].format = SDL_GPU_VERTEXELEMENTFORMAT_SHORT2_NORM;
+		vertex_attributes[1].offset = 8;
+	}
 
-	SDL_GPUVertexBufferDescription vertex_buffer_desc = {.slot = 0, .pitch = sizeof(Vertex), .input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX, .instance_step_rate = 0};
+	SDL_GPUVertexBufferDescription vertex_buffer_descs[2] = {
+	    {.slot = 0, .pitch = compact ? sizeof(CompactVertex) : sizeof(Vertex), .input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX, .instance_step_rate = 0},
+	    {.slot = 1, .pitch = sizeof(InstanceData), .input_rate = SDL_GPU_VERTEXINPUTRATE_INSTANCE, .instance_step_rate = 0}};
 
-	SDL_GPUVertexInputState vertex_input_state = {
-	    .vertex_buffer_descriptions = &vertex_buffer_desc, .num_vertex_buffers = 1, .vertex_attributes = vertex_attributes, .num_vertex_attributes = 2};
+	SDL_GPUVertexInputState vertex_input_state = {.vertex_buffer_descriptions = vertex_buffer_descs,
+	                                              .num_vertex_buffers = instanced ? 2 : 1,
+	                                              .vertex_attributes = vertex_attributes,
+	                                              .num_vertex_attributes = instanced ? 10 : 2};
+
+	/* no mesh at all, the instance data moves to slot 0 */
+	if (procedural)
+	{
+		for (int i = 2; i < 10; i++)
+			vertex_attributes[i].buffer_slot = 0;
+		vertex_buffer_descs[1].slot = 0;
+
+		vertex_input_state.vertex_buffer_descriptions = &vertex_buffer_descs[1];
+		vertex_input_state.num_vertex_buffers = 1;
+		vertex_input_state.vertex_attributes = &vertex_attributes[2];
+		vertex_input_state.num_vertex_attributes = 8;
+	}
 
 	SDL_GPUColorTargetDescription color_target = {
-	    .format = SDL_GetGPUSwapchainTextureFormat(render_state.device, usercfg->window),
+	    .format = usercfg->window ? SDL_GetGPUSwapchainTextureFormat(render_state.device, usercfg->window) : OFFSCREEN_FORMAT,
 	    .blend_state = {.src_color_blendfactor = SDL_GPU_BLENDFACTOR_ONE,
 	                    .dst_color_blendfactor = SDL_GPU_BLENDFACTOR_ZERO,
 	                    .color_blend_op = SDL_GPU_BLENDOP_ADD,
@@ -226,17 +297,19 @@ static int init_with_retry(InitParams *usercfg)
 	}
 
 	/* create gears */
-	float red[3] = {0.8f, 0.1f, 0.0f};
-	float green[3] = {0.0f, 0.8f, 0.2f};
-	float blue[3] = {0.2f, 0.2f, 1.0f};
+	render_state.render_mode = usercfg->render_mode;
+	render_state.vertex_format = usercfg->vertex_format;
+	render_state.mesh_generator = usercfg->mesh_generator;
+	render_state.verify_meshes = usercfg->verify_meshes;
+	if (!create_scene(render_state.device, usercfg->num_gears))
+		return 0;
 
-	if (!create_gear(render_state.device, &render_state.gears[0], 1.0f, 4.0f, 1.0f, 20, 0.7f, red) ||
-	    !create_gear(render_state.device, &render_state.gears[1], 0.5f, 2.0f, 2.0f, 10, 0.7f, green) ||
-	    !create_gear(render_state.device, &render_state.gears[2], 1.3f, 2.0f, 0.5f, 10, 0.7f, blue))
-	{
-		printf("Failed to create gear geometry\n");
+	if (indirect && !create_culling(render_state.device))
+		return 0;
+
+	render_state.cpu_culling = usercfg->cpu_culling && !indirect;
+	if (render_state.cpu_culling && !spatial_build(&render_state.layout, render_state.gear_params))
 		return 0;
-	}
 
 	/* initialize view parameters */
 	render_state.view_rotx = 20.0f;
@@ -244,29 +317,56 @@ static int init_with_retry(InitParams *usercfg)
 	render_state.view_rotz = 0.0f;
 	render_state.angle = 0.0f;
 
-	render_state.swapchain_valid = true;
+	if (usercfg->window)
+	{
+		/* a new swapchain starts out with VSYNC */
+		render_state.present_mode = set_present_mode(usercfg->window, VSYNC, usercfg->present_mode);
+		usercfg->present_mode = render_state.present_mode;
+	}
+	else
+	{
+		SDL_GPUTextureCreateInfo offscreen_info = {.type = SDL_GPU_TEXTURETYPE_2D,
+		                                           .format = OFFSCREEN_FORMAT,
+		                                           .usage = SDL_GPU_TEXTUREUSAGE_COLOR_TARGET,
+		                                           .width = usercfg->offscreen_width,
+		                                           .height = usercfg->offscreen_height,
+		                                           .layer_count_or_depth = 1,
+		                                           .num_levels = 1,
+		                                           .sample_count = SDL_GPU_SAMPLECOUNT_1,
+		                                           .props = 0};
+
+		render_state.offscreen_texture = SDL_CreateGPUTexture(render_state.device, &offscreen_info);
+		if (!render_state.offscreen_texture)
+		{
+			printf("Failed to create offscreen render target: %s\n", SDL_GetError());
+			return 0;
+		}
+		render_state.offscreen_width = usercfg->offscreen_width;
+		render_state.offscreen_height = usercfg->offscreen_height;
+	}
+	render_state.frames_in_flight = set_frames_in_flight(usercfg->window, 2 /* SDL's default */, usercfg->image_count);
+	usercfg->image_count = render_state.frames_in_flight;
 
-	set_swapchain_params(usercfg->window, &usercfg->present_mode, &usercfg->image_count);
+	/* RENDER_INDIRECT only draws from the culled copy that cull_gears.glsl/hlsl makes */
+	uint32_t instance_bytes = (instanced || procedural) ? (uint32_t)(render_state.layout.count * sizeof(InstanceData)) : 0;
+	if (!create_frame_resources(render_state.device, instance_bytes, indirect ? SDL_GPU_BUFFERUSAGE_COMPUTE_STORAGE_READ : SDL_GPU_BUFFERUSAGE_VERTEX))
+		return 0;
 
 	if (usercfg->verbose)
 	{
 		printf("GPU driver: %s\n", SDL_GetGPUDeviceDriver(render_state.device));
 		printf("Shader formats: 0x%08X\n", SDL_GetGPUShaderFormats(render_state.device));
-		const char *present_mode_name = "UNKNOWN";
-		switch (usercfg->present_mode)
+		printf("Present mode: %s\n", present_mode_name(usercfg->present_mode));
+		printf("Render mode: %s\n", procedural ? "PROCEDURAL" : (indirect ? "INDIRECT" : (instanced ? "INSTANCED" : "CLASSIC")));
+		if (procedural)
+			printf("Vertex format: NONE (built in the vertex shader)\n");
+		else
 		{
-		case VSYNC:
-			present_mode_name = "VSYNC";
-			break;
-		case IMMEDIATE:
-			present_mode_name = "IMMEDIATE";
-			break;
-		case MAILBOX:
-			present_mode_name = "MAILBOX";
-			break;
+			printf("Vertex format: %s (%u bytes)\n", compact ? "COMPACT" : "FULL", compact ? (unsigned int)sizeof(CompactVertex) : (unsigned int)sizeof(Vertex));
+			printf("Mesh generator: %s%s\n", usercfg->mesh_generator == MESHGEN_GPU ? "GPU" : "CPU", usercfg->verify_meshes ? " (verified)" : "");
 		}
-		printf("Present mode: %s\n", present_mode_name);
 		printf("Image count: %u\n", usercfg->image_count);
+		printf("Gears: %u%s\n", render_state.layout.count, render_state.cpu_culling ? " (cpu frustum culled)" : "");
 	}
 
 	/* save successful renderer */
@@ -275,40 +375,59 @@ static int init_with_retry(InitParams *usercfg)
 	return 1;
 }
 
-static void set_swapchain_params(SDL_Window *window, enum PresentMode *present_mode, unsigned int *image_count)
+PresentMode set_present_mode(SDL_Window *window, PresentMode current, PresentMode present_mode)
 {
 	/* the documentation says this is always supported, but not in reality... */
 	if (!SDL_WindowSupportsGPUSwapchainComposition(render_state.device, window, SDL_GPU_SWAPCHAINCOMPOSITION_SDR))
 	{
 		printf("Warning: GPU swapchain composition isn't supported for setting a custom present mode: %s\n", SDL_GetError());
-		*present_mode = VSYNC;
+		present_mode = VSYNC;
 	}
-	else
+	else if (!SDL_WindowSupportsGPUPresentMode(render_state.device, window, (SDL_GPUPresentMode)present_mode))
 	{
-		/* check if requested present mode is supported and set it */
-		if (!SDL_WindowSupportsGPUPresentMode(render_state.device, window, (SDL_GPUPresentMode)*present_mode))
-		{
-			printf("Notice: %s present mode not supported, using vsync\n", *present_mode == MAILBOX ? "mailbox" : "immediate");
-			*present_mode = VSYNC;
-		}
+		printf("Notice: %s present mode not supported, using vsync\n", present_mode_name(present_mode));
+		present_mode = VSYNC;
+	}
 
-		/* this is already the default, so only set the present_mode explicitly if it's not VSYNC */
-		if (*present_mode != VSYNC)
-		{
-			if (!SDL_SetGPUSwapchainParameters(render_state.device, window, SDL_GPU_SWAPCHAINCOMPOSITION_SDR, (SDL_GPUPresentMode)*present_mode))
-			{
-				printf("Warning: couldn't set swapchain parameters for custom present mode: %s\n", SDL_GetError());
-				*present_mode = VSYNC; /* if it failed, that means it must be using the "always supported" VSYNC */
-			}
-		}
+	/* recreates the swapchain, so only when it's actually different */
+	if (present_mode == current)
+		return current;
+
+	if (!SDL_SetGPUSwapchainParameters(render_state.device, window, SDL_GPU_SWAPCHAINCOMPOSITION_SDR, (SDL_GPUPresentMode)present_mode))
+	{
+		printf("Warning: couldn't set swapchain parameters for %s present mode: %s\n", present_mode_name(present_mode), SDL_GetError());
+		return current;
 	}
 
-	/* 2 is already default, so only set image_count explicitly if it's requested to be different */
-	if (!SDL_SetGPUAllowedFramesInFlight(render_state.device, *image_count))
+	return present_mode;
+}
+
+unsigned int set_frames_in_flight(SDL_Window *window, unsigned int current, unsigned int frames_in_flight)
+{
+	frames_in_flight = SDL_clamp(frames_in_flight, 1u, MAX_FRAMES_IN_FLIGHT);
+
+	/* without a swapchain, the frame ring in sdlgpu_frames.h is the only limit */
+	if (window && frames_in_flight != current && !SDL_SetGPUAllowedFramesInFlight(render_state.device, frames_in_flight))
+	{
+		printf("Warning: couldn't set max frames in flight to %u: %s\n", frames_in_flight, SDL_GetError());
+		return current;
+	}
+
+	return frames_in_flight;
+}
+
+const char *present_mode_name(PresentMode present_mode)
+{
+	switch (present_mode)
 	{
-		printf("Warning: couldn't set max frames in flight to %d: %s\n", *image_count, SDL_GetError());
-		*image_count = 2;
+	case VSYNC:
+		return "VSYNC";
+	case IMMEDIATE:
+		return "IMMEDIATE";
+	case MAILBOX:
+		return "MAILBOX";
 	}
+	return "UNKNOWN";
 }
 
 static Renderer get_actual_renderer(Renderer choice, bool print_driver_enumeration)
@@ -5,6 +5,8 @@
 #pragma once
 #include <stdbool.h>
 
+#include "sdlgpu_render.h"
+
 typedef struct SDL_Window SDL_Window;
 
 typedef enum Renderer
@@ -14,21 +16,34 @@ typedef enum Renderer
 	D3D12
 } Renderer;
 
-typedef enum PresentMode /* this matches the SDL_GPUPresentMode enum exactly */
-{
-	VSYNC,
-	IMMEDIATE,
-	MAILBOX
-} PresentMode;
-
 typedef struct InitParams
 {
-	SDL_Window *window;
+	SDL_Window *window; /* NULL to render headless into an offscreen texture */
+	unsigned int offscreen_width;
+	unsigned int offscreen_height;
 	PresentMode present_mode;
 	Renderer renderer;
+	RenderMode render_mode;
+	VertexFormat vertex_format;
+	MeshGenerator mesh_generator;
+	bool verify_meshes;
+	bool cpu_culling;
 	unsigned int image_count;
+	unsigned int num_gears;
 	bool verbose;
 } InitParams;
 
 bool init_gpu(InitParams *usercfg);
 void cleanup_gpu(void);
+
+/* runtime present configuration, on the thread that created the window only, since both recreate its swapchain
+ * they don't touch render_state: the result reaches whoever draws through ViewInput (see apply_present_config()) */
+
+/* switch the window's swapchain from current to present_mode, or to VSYNC if the window doesn't support it
+ * returns the present mode in use afterwards, which is current if even that fails */
+PresentMode set_present_mode(SDL_Window *window, PresentMode current, PresentMode present_mode);
+/* how many frames may be queued on the gpu (1-3), window may be NULL when rendering headless
+ * returns the count in use afterwards, which is current if SDL refuses */
+unsigned int set_frames_in_flight(SDL_Window *window, unsigned int current, unsigned int frames_in_flight);
+
+const char *present_mode_name(PresentMode present_mode);
@@ -0,0 +1,276 @@
+/*
+ * Copyright (C) 2025 William Horvath
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <SDL3/SDL_atomic.h>
+#include <SDL3/SDL_cpuinfo.h>
+#include <SDL3/SDL_mutex.h>
+#include <SDL3/SDL_thread.h>
+
+#include "sdlgpu_jobs.h"
+#include "sdlgpu_trace.h"
+
+#define MAX_JOB_THREADS 64
+#define DEQUE_CAPACITY 256 /* power of 2, ranges split in halves so a deque never holds more than a few per submission */
+
+/* a range of a parallel for, split further by whoever runs it */
+typedef struct Job
+{
+	JobFunc fn;
+	void *data;
+	uint32_t first, count;
+	uint32_t grain;
+	SDL_AtomicInt *pending; /* the submission's outstanding jobs, if anyone waits for it */
+} Job;
+
+/* the owner pushes and pops at the tail, thieves take from the head
+ * a spinlock is plenty here, jobs are coarse (at least a grain of items each) */
+typedef struct JobDeque
+{
+	SDL_SpinLock lock;
+	uint32_t head, tail; /* tail - head jobs, wrapping */
+	Job jobs[DEQUE_CAPACITY];
+} JobDeque;
+
+static struct
+{
+	JobDeque *deques; /* one per thread, [0] belongs to whichever thread submits */
+	SDL_Thread *threads[MAX_JOB_THREADS];
+	unsigned int num_threads;
+	SDL_Semaphore *wake;
+	SDL_AtomicInt sleeping;    /* workers waiting on wake, or about to */
+	SDL_AtomicInt outstanding; /* queued or running jobs, for jobs_frame_barrier() */
+	SDL_AtomicInt quit;
+} jobs;
+
+static bool push_job(JobDeque *deque, const Job *job)
+{
+	bool pushed = false;
+
+	SDL_LockSpinlock(&deque->lock);
+	if (deque->tail - deque->head < DEQUE_CAPACITY)
+	{
+		deque->jobs[deque->tail % DEQUE_CAPACITY] = *job;
+		deque->tail++;
+		pushed = true;
+	}
+	SDL_UnlockSpinlock(&deque->lock);
+
+	return pushed;
+}
+
+static bool pop_job(JobDeque *deque, Job *job)
+{
+	bool popped = false;
+
+	SDL_LockSpinlock(&deque->lock);
+	if (deque->tail != deque->head)
+	{
+		deque->tail--;
+		*job = deque->jobs[deque->tail % DEQUE_CAPACITY];
+		popped = true;
+	}
+	SDL_UnlockSpinlock(&deque->lock);
+
+	return popped;
+}
+
+static bool steal_job(JobDeque *deque, Job *job)
+{
+	bool stolen = false;
+
+	SDL_LockSpinlock(&deque->lock);
+	if (deque->tail != deque->head)
+	{
+		*job = deque->jobs[deque->head % DEQUE_CAPACITY];
+		deque->head++;
+		stolen = true;
+	}
+	SDL_UnlockSpinlock(&deque->lock);
+
+	return stolen;
+}
+
+/* makes a job visible to the other threads, false if the deque is full */
+static bool queue_job(unsigned int worker, const Job *job)
+{
+	if (job->pending)
+		SDL_AddAtomicInt(job->pending, 1);
+	SDL_AddAtomicInt(&jobs.outstanding, 1);
+
+	if (!push_job(&jobs.deques[worker], job))
+	{
+		if (job->pending)
+			SDL_AddAtomicInt(job->pending, -1);
+		SDL_AddAtomicInt(&jobs.outstanding, -1);
+		return false;
+	}
+
+	/* a worker going to sleep checks the deques after announcing it, so one of the two sides sees the other */
+	if (SDL_GetAtomicInt(&jobs.sleeping) > 0)
+		SDL_SignalSemaphore(jobs.wake);
+
+	return true;
+}
+
+/* keep the first half and offer the second to thieves until only a grain is left, then run it */
+static void run_job(Job job, unsigned int worker)
+{
+	while (job.count >= 2 * job.grain)
+	{
+		uint32_t half = job.count / job.grain / 2 * job.grain;
+		Job back = job;
+		back.first += half;
+		back.count -= half;
+		if (!queue_job(worker, &back))
+			break;
+		job.count = half;
+	}
+
+	job.fn(job.data, job.first, job.count, worker);
+}
+
+/* run one queued job, our own newest first, otherwise the oldest of another thread */
+static bool run_one(unsigned int worker)
+{
+	Job job;
+	bool found = pop_job(&jobs.deques[worker], &job);
+	for (unsigned int i = 1; !found && i < jobs.num_threads; i++)
+		found = steal_job(&jobs.deques[(worker + i) % jobs.num_threads], &job);
+
+	if (!found)
+		return false;
+
+	SDL_AtomicInt *pending = job.pending;
+	run_job(job, worker);
+
+	/* the waiter may return as soon as pending drops to 0, so it's the last thing touched of the submission */
+	if (pending)
+		SDL_AddAtomicInt(pending, -1);
+	SDL_AddAtomicInt(&jobs.outstanding, -1);
+	return true;
+}
+
+static int SDLCALL job_worker(void *data)
+{
+	unsigned int worker = (unsigned int)(uintptr_t)data;
+
+	while (!SDL_GetAtomicInt(&jobs.quit))
+	{
+		if (run_one(worker))
+			continue;
+
+		SDL_AddAtomicInt(&jobs.sleeping, 1);
+		if (!SDL_GetAtomicInt(&jobs.quit) && !run_one(worker))
+			SDL_WaitSemaphore(jobs.wake);
+		SDL_AddAtomicInt(&jobs.sleeping, -1);
+	}
+
+	return 0;
+}
+
+bool jobs_init(unsigned int num_threads)
+{
+	if (num_threads == 0)
+		num_threads = (unsigned int)SDL_max(SDL_GetNumLogicalCPUCores(), 1);
+	num_threads = SDL_min(num_threads, MAX_JOB_THREADS);
+
+	jobs.deques = (JobDeque *)calloc(num_threads, sizeof(JobDeque));
+	jobs.wake = SDL_CreateSemaphore(0);
+	if (!jobs.deques || !jobs.wake)
+	{
+		printf("Failed to create job system: %s\n", SDL_GetError());
+		jobs_shutdown();
+		return false;
+	}
+
+	SDL_SetAtomicInt(&jobs.sleeping, 0);
+	SDL_SetAtomicInt(&jobs.outstanding, 0);
+	SDL_SetAtomicInt(&jobs.quit, 0);
+	jobs.num_threads = num_threads;
+
+	/* a worker that doesn't start just leaves its share to the others */
+	for (unsigned int w = 1; w < num_threads; w++)
+	{
+		jobs.threads[w] = SDL_CreateThread(job_worker, "job_worker", (void *)(uintptr_t)w);
+		if (!jobs.threads[w])
+			printf("Warning: couldn't start job worker %u: %s\n", w, SDL_GetError());
+	}
+
+	return true;
+}
+
+void jobs_shutdown(void)
+{
+	if (jobs.num_threads)
+		jobs_frame_barrier();
+
+	SDL_SetAtomicInt(&jobs.quit, 1);
+	for (unsigned int w = 1; w < jobs.num_threads; w++)
+		SDL_SignalSemaphore(jobs.wake);
+
+	for (unsigned int w = 1; w < jobs.num_threads; w++)
+	{
+		if (jobs.threads[w])
+			SDL_WaitThread(jobs.threads[w], NULL);
+		jobs.threads[w] = NULL;
+	}
+
+	if (jobs.wake)
+		SDL_DestroySemaphore(jobs.wake);
+	free(jobs.deques);
+
+	jobs.wake = NULL;
+	jobs.deques = NULL;
+	jobs.num_threads = 0;
+}
+
+unsigned int jobs_thread_count(void)
+{
+	return SDL_max(jobs.num_threads, 1u);
+}
+
+static void submit(uint32_t count, uint32_t grain, JobFunc fn, void *data, SDL_AtomicInt *pending)
+{
+	if (count == 0)
+		return;
+
+	Job job = {.fn = fn, .data = data, .first = 0, .count = count, .grain = SDL_max(grain, 1u), .pending = pending};
+
+	/* nothing to split, or nobody to split it with */
+	if (jobs.num_threads <= 1 || count < 2 * job.grain || !queue_job(0, &job))
+		fn(data, 0, count, 0);
+}
+
+void jobs_submit_for(uint32_t count, uint32_t grain, JobFunc fn, void *data)
+{
+	submit(count, grain, fn, data, NULL);
+}
+
+void jobs_parallel_for(uint32_t count, uint32_t grain, JobFunc fn, void *data)
+{
+	SDL_AtomicInt pending;
+	SDL_SetAtomicInt(&pending, 0);
+
+	submit(count, grain, fn, data, &pending);
+	while (SDL_GetAtomicInt(&pending) > 0)
+	{
+		if (!run_one(0))
+			SDL_CPUPauseInstruction();
+	}
+}
+
+void jobs_frame_barrier(void)
+{
+	trace_begin("jobs_frame_barrier");
+	while (SDL_GetAtomicInt(&jobs.outstanding) > 0)
+	{
+		if (!run_one(0))
+			SDL_CPUPauseInstruction();
+	}
+	trace_end("jobs_frame_barrier");
+}
@@ -0,0 +1,31 @@
+/*
+ * Copyright (C) 2025 William Horvath
+ */
+
+#pragma once
+#include <stdbool.h>
+
+#include <stdint.h>
+
+/* work-stealing scheduler for CPU work that splits into independent ranges (per-gear transforms, mesh generation, ...)
+ * each thread owns a deque: jobs are pushed to and popped from the back of the submitting thread's one, idle workers steal from the front of the others
+ * jobs may only be submitted from one thread at a time, which takes over worker 0 and runs jobs while it waits for them
+ * (the thread that called jobs_init() until it hands rendering to a render thread) */
+
+/* runs items [first, first + count), worker is in [0, jobs_thread_count()) and unique among concurrently running jobs */
+typedef void (*JobFunc)(void *data, uint32_t first, uint32_t count, unsigned int worker);
+
+/* start num_threads - 1 worker threads next to the calling one, 0 for one per logical core, 1 to run everything inline */
+bool jobs_init(unsigned int num_threads);
+/* finish outstanding jobs and stop the workers */
+void jobs_shutdown(void);
+
+/* threads that run jobs, including the calling one (1 before jobs_init()), for sizing per-worker scratch */
+unsigned int jobs_thread_count(void);
+
+/* queue [0, count) in chunks of at least grain items, without waiting for them */
+void jobs_submit_for(uint32_t count, uint32_t grain, JobFunc fn, void *data);
+/* like jobs_submit_for(), but returns once all of its chunks are done */
+void jobs_parallel_for(uint32_t count, uint32_t grain, JobFunc fn, void *data);
+/* return once everything queued so far is done, e.g. before the frame's results are consumed */
+void jobs_frame_barrier(void);
@@ -11,14 +11,90 @@
 #define PI 3.14159265358979323846
 #endif
 
+/* matrices are column-major float[16], like OpenGL
+ * the kernels below are picked at compile time: AVX, SSE or NEON if the target has them, scalar otherwise
+ * (define SDLGPU_MATH_SCALAR to force the scalar versions) */
+#if !defined(SDLGPU_MATH_SCALAR)
+#if defined(__AVX__)
+#define MATH_AVX 1
+#define MATH_SSE 1
+#include <immintrin.h>
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define MATH_SSE 1
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define MATH_NEON 1
+#include <arm_neon.h>
+#endif
+#endif
+
 static inline void matrix_identity(float *m)
 {
 	memset(m, 0, 16 * sizeof(float));
 	m[0] = m[5] = m[10] = m[15] = 1.0f;
 }
 
+/* result = a * b, result may alias a and/or b */
 static inline void matrix_multiply(float *result, const float *a, const float *b)
 {
+#if defined(MATH_AVX)
+	/* two result columns per iteration: each 128-bit lane holds one column */
+	__m256 a0 = _mm256_broadcast_ps((const __m128 *)&a[0]);
+	__m256 a1 = _mm256_broadcast_ps((const __m128 *)&a[4]);
+	__m256 a2 = _mm256_broadcast_ps((const __m128 *)&a[8]);
+	__m256 a3 = _mm256_broadcast_ps((const __m128 *)&a[12]);
+	__m256 b01 = _mm256_loadu_ps(&b[0]);
+	__m256 b23 = _mm256_loadu_ps(&b[8]);
+
+	__m256 r01 = _mm256_mul_ps(a0, _mm256_shuffle_ps(b01, b01, _MM_SHUFFLE(0, 0, 0, 0)));
+	r01 = _mm256_add_ps(r01, _mm256_mul_ps(a1, _mm256_shuffle_ps(b01, b01, _MM_SHUFFLE(1, 1, 1, 1))));
+	r01 = _mm256_add_ps(r01, _mm256_mul_ps(a2, _mm256_shuffle_ps(b01, b01, _MM_SHUFFLE(2, 2, 2, 2))));
+	r01 = _mm256_add_ps(r01, _mm256_mul_ps(a3, _mm256_shuffle_ps(b01, b01, _MM_SHUFFLE(3, 3, 3, 3))));
+
+	__m256 r23 = _mm256_mul_ps(a0, _mm256_shuffle_ps(b23, b23, _MM_SHUFFLE(0, 0, 0, 0)));
+	r23 = _mm256_add_ps(r23, _mm256_mul_ps(a1, _mm256_shuffle_ps(b23, b23, _MM_SHUFFLE(1, 1, 1, 1))));
+	r23 = _mm256_add_ps(r23, _mm256_mul_ps(a2, _mm256_shuffle_ps(b23, b23, _MM_SHUFFLE(2, 2, 2, 2))));
+	r23 = _mm256_add_ps(r23, _mm256_mul_ps(a3, _mm256_shuffle_ps(b23, b23, _MM_SHUFFLE(3, 3, 3, 3))));
+
+	_mm256_storeu_ps(&result[0], r01);
+	_mm256_storeu_ps(&result[8], r23);
+#elif defined(MATH_SSE)
+	__m128 a0 = _mm_loadu_ps(&a[0]);
+	__m128 a1 = _mm_loadu_ps(&a[4]);
+	__m128 a2 = _mm_loadu_ps(&a[8]);
+	__m128 a3 = _mm_loadu_ps(&a[12]);
+	__m128 r[4];
+
+	for (int col = 0; col < 4; col++)
+	{
+		__m128 bc = _mm_loadu_ps(&b[col * 4]);
+		r[col] = _mm_mul_ps(a0, _mm_shuffle_ps(bc, bc, _MM_SHUFFLE(0, 0, 0, 0)));
+		r[col] = _mm_add_ps(r[col], _mm_mul_ps(a1, _mm_shuffle_ps(bc, bc, _MM_SHUFFLE(1, 1, 1, 1))));
+		r[col] = _mm_add_ps(r[col], _mm_mul_ps(a2, _mm_shuffle_ps(bc, bc, _MM_SHUFFLE(2, 2, 2, 2))));
+		r[col] = _mm_add_ps(r[col], _mm_mul_ps(a3, _mm_shuffle_ps(bc, bc, _MM_SHUFFLE(3, 3, 3, 3))));
+	}
+
+	for (int col = 0; col < 4; col++)
+		_mm_storeu_ps(&result[col * 4], r[col]);
+#elif defined(MATH_NEON)
+	float32x4_t a0 = vld1q_f32(&a[0]);
+	float32x4_t a1 = vld1q_f32(&a[4]);
+	float32x4_t a2 = vld1q_f32(&a[8]);
+	float32x4_t a3 = vld1q_f32(&a[12]);
+	float32x4_t r[4];
+
+	for (int col = 0; col < 4; col++)
+	{
+		float32x4_t bc = vld1q_f32(&b[col * 4]);
+		r[col] = vmulq_n_f32(a0, vgetq_lane_f32(bc, 0));
+		r[col] = vmlaq_n_f32(r[col], a1, vgetq_lane_f32(bc, 1));
+		r[col] = vmlaq_n_f32(r[col], a2, vgetq_lane_f32(bc, 2));
+		r[col] = vmlaq_n_f32(r[col], a3, vgetq_lane_f32(bc, 3));
+	}
+
+	for (int col = 0; col < 4; col++)
+		vst1q_f32(&result[col * 4], r[col]);
+#else
 	float temp[16];
 	for (int col = 0; col < 4; col++)
 	{
@@ -32,61 +108,72 @@ static inline void matrix_multiply(float *result, const float *a, const float *b
 		}
 	}
 	memcpy(result, temp, 16 * sizeof(float));
+#endif
 }
 
+/* m = m * translation, which only changes the last column: col3 += x * col0 + y * col1 + z * col2 */
 static inline void matrix_translate(float *m, float x, float y, float z)
 {
-	float trans[16];
-	matrix_identity(trans);
-	trans[12] = x;
-	trans[13] = y;
-	trans[14] = z;
-	matrix_multiply(m, m, trans);
+#if defined(MATH_SSE)
+	__m128 c3 = _mm_loadu_ps(&m[12]);
+	c3 = _mm_add_ps(c3, _mm_mul_ps(_mm_loadu_ps(&m[0]), _mm_set1_ps(x)));
+	c3 = _mm_add_ps(c3, _mm_mul_ps(_mm_loadu_ps(&m[4]), _mm_set1_ps(y)));
+	c3 = _mm_add_ps(c3, _mm_mul_ps(_mm_loadu_ps(&m[8]), _mm_set1_ps(z)));
+	_mm_storeu_ps(&m[12], c3);
+#elif defined(MATH_NEON)
+	float32x4_t c3 = vld1q_f32(&m[12]);
+	c3 = vmlaq_n_f32(c3, vld1q_f32(&m[0]), x);
+	c3 = vmlaq_n_f32(c3, vld1q_f32(&m[4]), y);
+	c3 = vmlaq_n_f32(c3, vld1q_f32(&m[8]), z);
+	vst1q_f32(&m[12], c3);
+#else
+	for (int row = 0; row < 4; row++)
+		m[12 + row] += m[row] * x + m[4 + row] * y + m[8 + row] * z;
+#endif
+}
+
+/* m = m * rotation in the plane of columns i and j: (col_i, col_j) = (c * col_i + s * col_j, c * col_j - s * col_i) */
+static inline void matrix_rotate_columns(float *m, int i, int j, float c, float s)
+{
+#if defined(MATH_SSE)
+	__m128 ci = _mm_loadu_ps(&m[i * 4]);
+	__m128 cj = _mm_loadu_ps(&m[j * 4]);
+	__m128 vc = _mm_set1_ps(c);
+	__m128 vs = _mm_set1_ps(s);
+	_mm_storeu_ps(&m[i * 4], _mm_add_ps(_mm_mul_ps(ci, vc), _mm_mul_ps(cj, vs)));
+	_mm_storeu_ps(&m[j * 4], _mm_sub_ps(_mm_mul_ps(cj, vc), _mm_mul_ps(ci, vs)));
+#elif defined(MATH_NEON)
+	float32x4_t ci = vld1q_f32(&m[i * 4]);
+	float32x4_t cj = vld1q_f32(&m[j * 4]);
+	vst1q_f32(&m[i * 4], vmlaq_n_f32(vmulq_n_f32(ci, c), cj, s));
+	vst1q_f32(&m[j * 4], vmlsq_n_f32(vmulq_n_f32(cj, c), ci, s));
+#else
+	for (int row = 0; row < 4; row++)
+	{
+		float mi = m[i * 4 + row];
+		float mj = m[j * 4 + row];
+		m[i * 4 + row] = mi * c + mj * s;
+		m[j * 4 + row] = mj * c - mi * s;
+	}
+#endif
 }
 
 static inline void matrix_rotate_x(float *m, float angle)
 {
-	float rot[16];
 	float rad = (float)(angle * PI / 180.0);
-	float c = cosf(rad);
-	float s = sinf(rad);
-
-	matrix_identity(rot);
-	rot[5] = c;
-	rot[6] = s;
-	rot[9] = -s;
-	rot[10] = c;
-	matrix_multiply(m, m, rot);
+	matrix_rotate_columns(m, 1, 2, cosf(rad), sinf(rad));
 }
 
 static inline void matrix_rotate_y(float *m, float angle)
 {
-	float rot[16];
 	float rad = (float)(angle * PI / 180.0);
-	float c = cosf(rad);
-	float s = sinf(rad);
-
-	matrix_identity(rot);
-	rot[0] = c;
-	rot[2] = -s;
-	rot[8] = s;
-	rot[10] = c;
-	matrix_multiply(m, m, rot);
+	matrix_rotate_columns(m, 0, 2, cosf(rad), -sinf(rad));
 }
 
 static inline void matrix_rotate_z(float *m, float angle)
 {
-	float rot[16];
 	float rad = (float)(angle * PI / 180.0);
-	float c = cosf(rad);
-	float s = sinf(rad);
-
-	matrix_identity(rot);
-	rot[0] = c;
-	rot[1] = s;
-	rot[4] = -s;
-	rot[5] = c;
-	matrix_multiply(m, m, rot);
+	matrix_rotate_columns(m, 0, 1, cosf(rad), sinf(rad));
 }
 
 static inline void matrix_frustum(float *m, float left, float right, float bottom, float top, float near, float far)
@@ -8,8 +8,18 @@
 #include <SDL3/SDL_time.h>
 #include <SDL3/SDL_timer.h>
 
+#include "sdlgpu_culling.h"
+#include "sdlgpu_frames.h"
+#include "sdlgpu_init.h"
+#include "sdlgpu_jobs.h"
 #include "sdlgpu_math.h"
 #include "sdlgpu_render.h"
+#include "sdlgpu_spatial.h"
+#include "sdlgpu_targets.h"
+#include "sdlgpu_timing.h"
+#include "sdlgpu_trace.h"
+#include "sdlgpu_transform.h"
+#include "sdlgpu_tuner.h"
 
 #ifdef __cplusplus
 #define Z_INIT {}
@@ -17,9 +27,14 @@
 #define Z_INIT {0}
 #endif
 
+/* frames a new present configuration gets to settle before its readout */
+#define PRESENT_READOUT_FRAMES 240
+
 /* global */
 RenderState render_state = Z_INIT;
 
+static bool present_readout; /* a switch is waiting for its readout */
+
 static inline double current_time(void)
 {
 	static SDL_Time time = 0;
@@ -29,29 +44,325 @@ static inline double current_time(void)
 	return (double)time / (double)SDL_NS_PER_SECOND;
 }
 
-static bool create_depth_texture(SDL_GPUDevice *device, uint32_t width, uint32_t height);
-void draw_frame(SDL_Window *window)
+/* the gears drawn this frame: every one in layout order, or the ascending survivors of the cpu frustum cull */
+typedef struct DrawList
+{
+	const uint32_t *gears; /* NULL for all of them */
+	uint32_t count;
+} DrawList;
+
+static inline uint32_t draw_list_gear(const DrawList *list, uint32_t k)
+{
+	return list->gears ? list->gears[k] : k;
+}
+
+/* the run of consecutive gears sharing a mesh that starts at list entry *k, which is moved past it */
+static uint32_t next_run(const DrawList *list, uint32_t *k, uint32_t *first)
+{
+	const GearLayout *layout = &render_state.layout;
+	uint32_t count = 1;
+
+	*first = draw_list_gear(list, *k);
+	while (*k + count < list->count && draw_list_gear(list, *k + count) == *first + count && layout->mesh[*first + count] == layout->mesh[*first])
+		count++;
+
+	*k += count;
+	return count;
+}
+
+/* gears per transform job, a multiple of transform_gears()' batch of 4 */
+#define TRANSFORM_GRAIN 256
+
+typedef struct TransformJob
+{
+	const DrawList *list;
+	const float *view, *projection;
+	float angle;
+	InstanceData *out;
+} TransformJob;
+
+/* each gear lands at its layout index, so the draws can address it the same way with or without culling */
+static void transform_job(void *data, uint32_t first, uint32_t count, unsigned int worker)
+{
+	(void)worker;
+	const TransformJob *job = (const TransformJob *)data;
+
+	if (!job->list->gears)
+	{
+		transform_gears(&render_state.layout, first, count, job->angle, job->view, job->projection, job->out + first);
+		return;
+	}
+
+	/* contiguous stretches of the list still go through the batched path */
+	uint32_t end = first + count;
+	while (first < end)
+	{
+		uint32_t gear = job->list->gears[first];
+		uint32_t n = 1;
+		while (first + n < end && job->list->gears[first + n] == gear + n)
+			n++;
+
+		transform_gears(&render_state.layout, gear, n, job->angle, job->view, job->projection, job->out + gear);
+		first += n;
+	}
+}
+
+/* fill the instance buffer for this frame, must be called outside of a render pass */
+static bool upload_instances(SDL_GPUCommandBuffer *cmd, const FrameResources *frame, const DrawList *list, const float *view, const float *projection)
+{
+	/* the gpu is done with this frame's buffers, so there's no need to cycle them */
+	InstanceData *instances = (InstanceData *)SDL_MapGPUTransferBuffer(render_state.device, frame->instance_transfer_buffer, false);
+	if (!instances)
+		return false;
+
+	/* written straight into the mapped upload buffer, spread over the job threads once there's enough of them */
+	TransformJob job = {.list = list, .view = view, .projection = projection, .angle = render_state.angle, .out = instances};
+	jobs_submit_for(list->count, TRANSFORM_GRAIN, transform_job, &job);
+	jobs_frame_barrier();
+
+	SDL_UnmapGPUTransferBuffer(render_state.device, frame->instance_transfer_buffer);
+
+	SDL_GPUCopyPass *copy_pass = SDL_BeginGPUCopyPass(cmd);
+
+	/* only the stretch of the buffer that this frame's gears span */
+	if (list->count > 0)
+	{
+		uint32_t first = draw_list_gear(list, 0);
+		uint32_t last = draw_list_gear(list, list->count - 1);
+		SDL_GPUTransferBufferLocation src = {frame->instance_transfer_buffer, (uint32_t)(first * sizeof(InstanceData))};
+		SDL_GPUBufferRegion dst = {frame->instance_buffer, (uint32_t)(first * sizeof(InstanceData)), (uint32_t)((last - first + 1) * sizeof(InstanceData))};
+		SDL_UploadToGPUBuffer(copy_pass, &src, &dst, false);
+	}
+	if (render_state.render_mode == RENDER_INDIRECT)
+		reset_culled_draws(copy_pass);
+	SDL_EndGPUCopyPass(copy_pass);
+
+	return true;
+}
+
+/* all meshes live in the geometry pool, so this is the only vertex/index bind for slot 0 */
+static void bind_geometry(SDL_GPURenderPass *render_pass)
+{
+	const GeometryPool *pool = &render_state.geometry;
+
+	SDL_GPUBufferBinding vertex_binding = {.buffer = pool->vertex_buffer, .offset = 0};
+	SDL_BindGPUVertexBuffers(render_pass, 0, &vertex_binding, 1);
+
+	SDL_GPUBufferBinding index_binding = {.buffer = pool->index_buffer, .offset = 0};
+	SDL_BindGPUIndexBuffer(render_pass, &index_binding, pool->index_size == 2 ? SDL_GPU_INDEXELEMENTSIZE_16BIT : SDL_GPU_INDEXELEMENTSIZE_32BIT);
+}
+
+static void draw_gears_classic(SDL_GPUCommandBuffer *cmd, SDL_GPURenderPass *render_pass, const DrawList *list, const float *view, const float *projection,
+                               const float eye_light_dir[3])
 {
-	/* uniform data passed to shaders, in std140 layout */
-	static struct Uniforms
+	/* uniform data passed to vertex.glsl/hlsl, in std140 layout: whatever is the same for every gear goes in slot 0 once per frame */
+	struct FrameUniforms
+	{
+		float view_projection[16]; /* mat4: 64 bytes */
+		float view[16];            /* mat4: 64 bytes */
+		float light_position[4];   /* vec3 padded to vec4: 16 bytes */
+		float light_color[4];      /* vec3 padded to vec4: 16 bytes */
+	} frame_uniforms;
+
+	/* and the rest in slot 1 per gear, the model matrix as the rotation around z and translation it's built from */
+	struct DrawUniforms
+	{
+		float translation[4];  /* vec3 padded to vec4: 16 bytes */
+		float rotation[4];     /* vec2 (cos, sin) padded to vec4: 16 bytes */
+		float object_color[4]; /* vec3 padded to vec4: 16 bytes */
+	} draw_uniforms = Z_INIT;
+
+	matrix_multiply(frame_uniforms.view_projection, projection, view);
+	memcpy(frame_uniforms.view, view, sizeof(frame_uniforms.view));
+
+	/* use eye-space light direction directly (like OpenGL) */
+	frame_uniforms.light_position[0] = eye_light_dir[0];
+	frame_uniforms.light_position[1] = eye_light_dir[1];
+	frame_uniforms.light_position[2] = eye_light_dir[2];
+	frame_uniforms.light_position[3] = 0.0f; /* w=0 for directional light */
+
+	frame_uniforms.light_color[0] = 1.0f;
+	frame_uniforms.light_color[1] = 1.0f;
+	frame_uniforms.light_color[2] = 1.0f;
+	frame_uniforms.light_color[3] = 0.0f; /* padding */
+
+	SDL_PushGPUVertexUniformData(cmd, 0, &frame_uniforms, sizeof(frame_uniforms));
+
+	bind_geometry(render_pass);
+
+	const GearLayout *layout = &render_state.layout;
+	for (uint32_t k = 0; k < list->count; k++)
+	{
+		uint32_t i = draw_list_gear(list, k);
+		const GearData *mesh = &render_state.gears[layout->mesh[i]];
+
+		float rad = (float)((layout->ratio[i] * render_state.angle + layout->phase[i]) * PI / 180.0);
+
+		draw_uniforms.translation[0] = layout->x[i];
+		draw_uniforms.translation[1] = layout->y[i];
+		draw_uniforms.translation[2] = layout->z[i];
+
+		draw_uniforms.rotation[0] = cosf(rad);
+		draw_uniforms.rotation[1] = sinf(rad);
+
+		draw_uniforms.object_color[0] = layout->color[i][0];
+		draw_uniforms.object_color[1] = layout->color[i][1];
+		draw_uniforms.object_color[2] = layout->color[i][2];
+
+		/* push uniforms to vertex shader */
+		SDL_PushGPUVertexUniformData(cmd, 1, &draw_uniforms, sizeof(draw_uniforms));
+
+		/* draw */
+		SDL_DrawGPUIndexedPrimitives(render_pass, mesh->index_count, 1, mesh->first_index, mesh->vertex_offset, 0);
+	}
+}
+
+/* must match vertex_instanced.glsl/hlsl, everything per-gear is in the instance buffer, only the light is left as a uniform */
+typedef struct InstancedUniforms
+{
+	float light_position[4]; /* vec3 padded to vec4: 16 bytes */
+	float light_color[4];    /* vec3 padded to vec4: 16 bytes */
+} InstancedUniforms;
+
+/* for RENDER_INSTANCED and RENDER_INDIRECT, which share their shaders */
+static void push_instanced_uniforms(SDL_GPUCommandBuffer *cmd, const float eye_light_dir[3])
+{
+	InstancedUniforms uniforms = {{eye_light_dir[0], eye_light_dir[1], eye_light_dir[2], 0.0f}, {1.0f, 1.0f, 1.0f, 0.0f}};
+	SDL_PushGPUVertexUniformData(cmd, 0, &uniforms, sizeof(uniforms));
+}
+
+static void draw_gears_instanced(SDL_GPUCommandBuffer *cmd, SDL_GPURenderPass *render_pass, const FrameResources *frame, const DrawList *list,
+                                 const float eye_light_dir[3])
+{
+	push_instanced_uniforms(cmd, eye_light_dir);
+
+	bind_geometry(render_pass);
+
+	/* instance data stays bound at slot 1 for the whole pass */
+	SDL_GPUBufferBinding instance_binding = {.buffer = frame->instance_buffer, .offset = 0};
+	SDL_BindGPUVertexBuffers(render_pass, 1, &instance_binding, 1);
+
+	/* one draw per run of consecutive instances sharing a mesh */
+	uint32_t k = 0;
+	while (k < list->count)
+	{
+		uint32_t first;
+		uint32_t count = next_run(list, &k, &first);
+
+		const GearData *mesh = &render_state.gears[render_state.layout.mesh[first]];
+
+		/* instance-rate attributes honor first_instance on every backend (unlike SV_InstanceID) */
+		SDL_DrawGPUIndexedPrimitives(render_pass, mesh->index_count, count, mesh->first_index, mesh->vertex_offset, first);
+	}
+}
+
+static void draw_gears_indirect(SDL_GPUCommandBuffer *cmd, SDL_GPURenderPass *render_pass, const float eye_light_dir[3])
+{
+	/* same uniforms and shaders as draw_gears_instanced, cull_gears() already decided what gets drawn */
+	push_instanced_uniforms(cmd, eye_light_dir);
+
+	bind_geometry(render_pass);
+	draw_culled_gears(render_pass);
+}
+
+static void draw_gears_procedural(SDL_GPUCommandBuffer *cmd, SDL_GPURenderPass *render_pass, const FrameResources *frame, const DrawList *list,
+                                  const float eye_light_dir[3])
+{
+	/* must match vertex_procedural.glsl/hlsl, the mesh shape changes per draw */
+	struct ProceduralUniforms
 	{
-		float mvp_matrix[16];    /* mat4: 64 bytes */
-		float model_matrix[16];  /* mat4: 64 bytes */
-		float normal_matrix[12]; /* mat3 in std140: 3 vec3s, each padded to vec4 = 48 bytes */
 		float light_position[4]; /* vec3 padded to vec4: 16 bytes */
 		float light_color[4];    /* vec3 padded to vec4: 16 bytes */
-		float object_color[4];   /* vec3 padded to vec4: 16 bytes */
-	} uniforms = Z_INIT;
+		float shape[4];          /* inner_radius, outer_radius, width, tooth_depth */
+		uint32_t teeth;
+		uint32_t padding[3];
+	} uniforms = {{eye_light_dir[0], eye_light_dir[1], eye_light_dir[2], 0.0f}, {1.0f, 1.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 0.0f, 0.0f}, 0, {0, 0, 0}};
+
+	/* the instance data is the only vertex buffer */
+	SDL_GPUBufferBinding instance_binding = {.buffer = frame->instance_buffer, .offset = 0};
+	SDL_BindGPUVertexBuffers(render_pass, 0, &instance_binding, 1);
+
+	/* one draw per run of consecutive instances sharing a mesh, same as draw_gears_instanced */
+	uint32_t k = 0;
+	while (k < list->count)
+	{
+		uint32_t first;
+		uint32_t count = next_run(list, &k, &first);
+		uint32_t mesh_index = render_state.layout.mesh[first];
+
+		const GearParams *params = &render_state.gear_params[mesh_index];
+		uniforms.shape[0] = params->inner_radius;
+		uniforms.shape[1] = params->outer_radius;
+		uniforms.shape[2] = params->width;
+		uniforms.shape[3] = params->tooth_depth;
+		uniforms.teeth = (uint32_t)params->teeth;
+		SDL_PushGPUVertexUniformData(cmd, 0, &uniforms, sizeof(uniforms));
+
+		/* non-indexed, the shader derives every vertex from its vertex id */
+		SDL_DrawGPUPrimitives(render_pass, render_state.gears[mesh_index].index_count, count, 0, first);
+	}
+}
+
+/* returns a command buffer along with the render target and its size, or NULL if this frame should be skipped */
+static SDL_GPUCommandBuffer *acquire_frame(SDL_Window *window, FrameResources **frame, SDL_GPUTexture **target, uint32_t *w, uint32_t *h)
+{
+	/* the frame that last used this slot must be done before its buffers are rewritten, without a swapchain this is also what throttles us */
+	*frame = acquire_frame_resources();
 
+	/* acquire command buffer and swapchain texture */
+	SDL_GPUCommandBuffer *cmd = SDL_AcquireGPUCommandBuffer(render_state.device);
+	if (!cmd)
+		return NULL;
+
+	*target = NULL;
+	if (!window)
+	{
+		*target = render_state.offscreen_texture;
+		*w = render_state.offscreen_width;
+		*h = render_state.offscreen_height;
+	}
+	else
+	{
+		trace_begin("wait_and_acquire_swapchain");
+		bool acquired = SDL_WaitAndAcquireGPUSwapchainTexture(cmd, window, target, w, h);
+		trace_end("wait_and_acquire_swapchain");
+		if (!acquired)
+		{
+			SDL_CancelGPUCommandBuffer(cmd);
+			return NULL;
+		}
+	}
+
+	/* pooled and usually larger than the target, the viewport keeps us to the w x h corner */
+	render_state.depth_texture = *target ? acquire_depth_target(render_state.device, *w, *h) : NULL;
+	if (!render_state.depth_texture)
+	{
+		SDL_CancelGPUCommandBuffer(cmd);
+		return NULL;
+	}
+
+	return cmd;
+}
+
+static void print_present_readout(void);
+bool draw_frame(SDL_Window *window)
+{
 	static int frames = 0;
 	static double tRot0 = -1.0;
 	static double tRate0 = -1.0;
 	double dt = 0.0f;
 	double t = current_time();
 
+	timing_begin_frame();
+	trace_begin("draw_frame");
+
+	/* nobody's pressing keys during calibration, so pretend every frame starts with new input to get a latency estimate for each */
+	if (tuner_active())
+		render_state.input_time = SDL_GetTicksNS();
+
 	if (tRot0 < 0.0)
 		tRot0 = t;
-	dt = t - tRot0;
+	dt = render_state.fixed_timestep > 0.0 ? render_state.fixed_timestep : t - tRot0;
 	tRot0 = t;
 
 	if (!render_state.pause_animation)
@@ -61,49 +372,30 @@ void draw_frame(SDL_Window *window)
 			render_state.angle -= 3600.0f;
 	}
 
-	if (!render_state.swapchain_valid)
-	{
-		/* this might be an SDL_gpu bug, but resize events aren't properly synchronized sometimes */
-		if (!SDL_WaitForGPUIdle(render_state.device))
-			return; /* maybe try again? this should never really return false... */
-		render_state.swapchain_valid = true;
-	}
-
-	/* acquire command buffer and swapchain texture */
-	SDL_GPUCommandBuffer *cmd = SDL_AcquireGPUCommandBuffer(render_state.device);
-	if (!cmd)
-		return;
-
+	trace_begin("acquire");
+	FrameResources *frame = NULL;
 	SDL_GPUTexture *swapchain_texture = NULL;
 	uint32_t w = 0, h = 0;
-	if (!SDL_WaitAndAcquireGPUSwapchainTexture(cmd, window, &swapchain_texture, &w, &h))
-	{
-		SDL_CancelGPUCommandBuffer(cmd);
-		return;
-	}
+	SDL_GPUCommandBuffer *cmd = acquire_frame(window, &frame, &swapchain_texture, &w, &h);
+	trace_end("acquire");
 
-	if (!swapchain_texture)
+	if (!cmd)
 	{
-		SDL_CancelGPUCommandBuffer(cmd);
-		return;
+		trace_end("draw_frame");
+		return false;
 	}
 
-	if (!create_depth_texture(render_state.device, w, h))
-	{
-		SDL_CancelGPUCommandBuffer(cmd);
-		return;
-	}
+	timing_mark(PHASE_ACQUIRE);
+	trace_begin("setup");
 
 	/* setup matrices and aspect ratio like OpenGL */
-	float *model = uniforms.model_matrix;
-	float *mvp = uniforms.mvp_matrix;
 	float projection[16], view[16];
 
 	float h_aspect = (float)h / (float)w;
-	matrix_frustum(projection, -1.0f, 1.0f, -h_aspect, h_aspect, 5.0f, 60.0f);
+	matrix_frustum(projection, -1.0f, 1.0f, -h_aspect, h_aspect, 5.0f, render_state.z_far);
 
 	matrix_identity(view);
-	matrix_translate(view, 0.0f, 0.0f, -40.0f);
+	matrix_translate(view, 0.0f, 0.0f, -render_state.view_distance);
 	matrix_rotate_x(view, render_state.view_rotx);
 	matrix_rotate_y(view, render_state.view_roty);
 	matrix_rotate_z(view, render_state.view_rotz);
@@ -112,6 +404,35 @@ void draw_frame(SDL_Window *window)
 	/* original OpenGL light position in eye space: (5.0, 5.0, 10.0, 0.0) */
 	float eye_light_dir[3] = {5.0f, 5.0f, 10.0f};
 
+	/* RENDER_INDIRECT culls on the gpu instead */
+	DrawList list = {.gears = NULL, .count = render_state.layout.count};
+	if (render_state.cpu_culling && render_state.render_mode != RENDER_INDIRECT)
+	{
+		float view_projection[16];
+		matrix_multiply(view_projection, projection, view);
+
+		trace_begin("cull");
+		list.count = spatial_query_frustum(view_projection, &list.gears);
+		trace_end("cull");
+	}
+
+	if (render_state.render_mode != RENDER_CLASSIC && !upload_instances(cmd, frame, &list, view, projection))
+	{
+		SDL_CancelGPUCommandBuffer(cmd);
+		trace_end("setup");
+		trace_end("draw_frame");
+		return false;
+	}
+
+	/* reads this frame's instances, so it goes between their upload and the render pass */
+	if (render_state.render_mode == RENDER_INDIRECT)
+		cull_gears(cmd, frame->instance_buffer);
+
+	/* the classic path computes per-gear matrices while recording, so those count towards PHASE_RECORD */
+	timing_mark(PHASE_SETUP);
+	trace_end("setup");
+	trace_begin("record");
+
 	/* setup render pass */
 	SDL_GPUColorTargetInfo color_target = {.texture = swapchain_texture,
 	                                       .mip_level = 0,
@@ -144,62 +465,52 @@ void draw_frame(SDL_Window *window)
 	SDL_BindGPUGraphicsPipeline(render_pass, render_state.pipeline);
 
 	/* draw gears */
-	struct
-	{
-		float x, y, z;
-		float rot;
-	} gear_transforms[3] = {
-	    {-3.0f, -2.0f, 0.0f, render_state.angle}, {3.1f, -2.0f, 0.0f, -2.0f * render_state.angle - 9.0f}, {-3.1f, 4.2f, 0.0f, -2.0f * render_state.angle - 25.0f}};
+	if (render_state.render_mode == RENDER_PROCEDURAL)
+		draw_gears_procedural(cmd, render_pass, frame, &list, eye_light_dir);
+	else if (render_state.render_mode == RENDER_INSTANCED)
+		draw_gears_instanced(cmd, render_pass, frame, &list, eye_light_dir);
+	else if (render_state.render_mode == RENDER_INDIRECT)
+		draw_gears_indirect(cmd, render_pass, eye_light_dir);
+	else
+		draw_gears_classic(cmd, render_pass, &list, view, projection, eye_light_dir);
 
-	for (int i = 0; i < 3; i++)
-	{
-		matrix_identity(model);
-		matrix_translate(model, gear_transforms[i].x, gear_transforms[i].y, gear_transforms[i].z);
-		matrix_rotate_z(model, gear_transforms[i].rot);
-
-		/* compute model-view matrix for proper view-space lighting */
-		float model_view[16];
-		matrix_multiply(model_view, view, model);
-
-		matrix_multiply(mvp, projection, model_view);
-
-		/* extract normal matrix from model-view for view-space lighting */
-		matrix_extract_3x3_std140(uniforms.normal_matrix, model_view);
+	SDL_EndGPURenderPass(render_pass);
 
-		/* use eye-space light direction directly (like OpenGL) */
-		uniforms.light_position[0] = eye_light_dir[0];
-		uniforms.light_position[1] = eye_light_dir[1];
-		uniforms.light_position[2] = eye_light_dir[2];
-		uniforms.light_position[3] = 0.0f; /* w=0 for directional light */
+	timing_mark(PHASE_RECORD);
+	trace_end("record");
+	trace_begin("submit");
 
-		uniforms.light_color[0] = 1.0f;
-		uniforms.light_color[1] = 1.0f;
-		uniforms.light_color[2] = 1.0f;
-		uniforms.light_color[3] = 0.0f; /* padding */
+	bool submitted = submit_frame(cmd);
 
-		uniforms.object_color[0] = render_state.gears[i].color[0];
-		uniforms.object_color[1] = render_state.gears[i].color[1];
-		uniforms.object_color[2] = render_state.gears[i].color[2];
-		uniforms.object_color[3] = 0.0f; /* padding */
+	/* the first frame to show new input stands in for when it gets presented */
+	static uint64_t shown_input_time = 0;
+	uint64_t new_input_time = 0;
+	if (render_state.input_time > shown_input_time)
+	{
+		shown_input_time = new_input_time = render_state.input_time;
+		if (!render_state.publish_frame)
+			timing_input_latency((double)(SDL_GetTicksNS() - shown_input_time) / (double)SDL_NS_PER_MS, frames_pending());
+	}
 
-		/* push uniforms to vertex shader */
-		SDL_PushGPUVertexUniformData(cmd, 0, &uniforms, sizeof(uniforms));
+	timing_mark(PHASE_SUBMIT);
+	trace_end("submit");
 
-		/* bind vertex buffer */
-		SDL_GPUBufferBinding vertex_binding = {.buffer = render_state.gears[i].vertex_buffer, .offset = 0};
-		SDL_BindGPUVertexBuffers(render_pass, 0, &vertex_binding, 1);
+	/* the swapchain wait is on the presenting thread then, which only takes the next frame once it has presented the last one */
+	if (submitted && render_state.publish_frame)
+	{
+		render_state.publish_frame(new_input_time);
+		timing_mark(PHASE_ACQUIRE);
+	}
 
-		/* bind index buffer */
-		SDL_GPUBufferBinding index_binding = {.buffer = render_state.gears[i].index_buffer, .offset = 0};
-		SDL_BindGPUIndexBuffer(render_pass, &index_binding, SDL_GPU_INDEXELEMENTSIZE_32BIT);
+	timing_end_frame();
 
-		/* draw */
-		SDL_DrawGPUIndexedPrimitives(render_pass, render_state.gears[i].index_count, 1, 0, 0, 0);
+	/* just a count, the stats themselves are only worth computing once they're printed */
+	if (present_readout && timing_window_frames() >= PRESENT_READOUT_FRAMES)
+	{
+		print_present_readout();
+		present_readout = false;
 	}
 
-	SDL_EndGPURenderPass(render_pass);
-	SDL_SubmitGPUCommandBuffer(cmd);
-
 	frames++;
 
 	if (tRate0 < 0.0)
@@ -209,37 +520,48 @@ void draw_frame(SDL_Window *window)
 		double seconds = t - tRate0;
 		double fps = frames / seconds;
 		printf("%d frames in %3.1f seconds = %6.3f FPS\n", frames, seconds, fps);
-		fflush(stdout);
+		timing_report();
+		print_present_readout();
+		render_targets_report();
 		tRate0 = t;
 		frames = 0;
 	}
+
+	trace_end("draw_frame");
+	return submitted;
 }
 
-/* lazy creation/recreation */
-static bool create_depth_texture(SDL_GPUDevice *device, uint32_t width, uint32_t height)
+/* the acquire wait and latency of the current present configuration, over the frames since it was switched to */
+static void print_present_readout(void)
 {
-	if (render_state.depth_texture && render_state.depth_texture_width == width && render_state.depth_texture_height == height)
-		return true; /* already have correct size */
+	WindowStats stats;
+	if (!timing_window_stats(&stats))
+		return;
 
-	/* release old depth texture */
-	if (render_state.depth_texture)
-		SDL_ReleaseGPUTexture(device, render_state.depth_texture);
+	printf("  present: %s, %u frames in flight: acquire wait %.3f ms (p95 %.3f), frame %.3f ms (p95 %.3f)", present_mode_name(render_state.present_mode),
+	       render_state.frames_in_flight, stats.acquire_mean, stats.acquire_p95, stats.frame_mean, stats.frame_p95);
+	if (stats.latency_samples)
+		printf(", input-to-present ~%.3f ms (p95 %.3f, %u inputs)\n", stats.latency_mean, stats.latency_p95, stats.latency_samples);
+	else
+		printf(", no input to estimate latency from\n");
+	fflush(stdout);
+}
+
+void apply_present_config(PresentMode present_mode, uint32_t frames_in_flight)
+{
+	if (present_mode == render_state.present_mode && frames_in_flight == render_state.frames_in_flight)
+		return;
 
-	SDL_GPUTextureCreateInfo depth_info = {.type = SDL_GPU_TEXTURETYPE_2D,
-	                                       .format = SDL_GPU_TEXTUREFORMAT_D32_FLOAT,
-	                                       .usage = SDL_GPU_TEXTUREUSAGE_DEPTH_STENCIL_TARGET,
-	                                       .width = width,
-	                                       .height = height,
-	                                       .layer_count_or_depth = 1,
-	                                       .num_levels = 1,
-	                                       .sample_count = SDL_GPU_SAMPLECOUNT_1,
-	                                       .props = 0};
+	/* slots past the new count keep their fences until they're polled or destroyed, so no frame in flight loses its buffers */
+	render_state.present_mode = present_mode;
+	render_state.frames_in_flight = frames_in_flight;
+	render_state.frame_slot %= frames_in_flight;
 
-	render_state.depth_texture = SDL_CreateGPUTexture(device, &depth_info);
-	if (!render_state.depth_texture)
-		return false;
+	/* the tuner measures configurations itself */
+	if (tuner_active())
+		return;
 
-	render_state.depth_texture_width = width;
-	render_state.depth_texture_height = height;
-	return true;
+	printf("Switched to %s, %u frames in flight\n", present_mode_name(render_state.present_mode), render_state.frames_in_flight);
+	timing_begin_window();
+	present_readout = true;
 }
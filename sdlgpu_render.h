@@ -9,11 +9,44 @@
 
 typedef struct SDL_GPUBuffer SDL_GPUBuffer;
 typedef struct SDL_GPUDevice SDL_GPUDevice;
+typedef struct SDL_GPUFence SDL_GPUFence;
 typedef struct SDL_GPUGraphicsPipeline SDL_GPUGraphicsPipeline;
 typedef struct SDL_GPUShader SDL_GPUShader;
 typedef struct SDL_GPUTexture SDL_GPUTexture;
+typedef struct SDL_GPUTransferBuffer SDL_GPUTransferBuffer;
 typedef struct SDL_Window SDL_Window;
 
+/* how the window's swapchain presents, this matches the SDL_GPUPresentMode enum exactly */
+typedef enum PresentMode
+{
+	VSYNC,
+	IMMEDIATE,
+	MAILBOX
+} PresentMode;
+
+/* how gears are submitted to the gpu */
+typedef enum RenderMode
+{
+	RENDER_CLASSIC,    /* one uniform push + draw per gear, like the original */
+	RENDER_INSTANCED,  /* per-gear data in an instance buffer, one draw per mesh */
+	RENDER_PROCEDURAL, /* like RENDER_INSTANCED, but the vertex shader builds the mesh from its GearParams, no vertex or index buffers */
+	RENDER_INDIRECT    /* like RENDER_INSTANCED, but a compute pass frustum culls the gears and writes the draws (see sdlgpu_culling.h) */
+} RenderMode;
+
+/* layout of the gear vertex buffers */
+typedef enum VertexFormat
+{
+	VERTEX_FULL,   /* Vertex, float3 position + float3 normal */
+	VERTEX_COMPACT /* CompactVertex, half position + octahedral snorm16 normal */
+} VertexFormat;
+
+/* where the gear meshes of RENDER_CLASSIC/RENDER_INSTANCED/RENDER_INDIRECT are built */
+typedef enum MeshGenerator
+{
+	MESHGEN_CPU, /* create_gears(), welded and uploaded */
+	MESHGEN_GPU  /* create_gears_gpu(), written into the pool by a compute shader */
+} MeshGenerator;
+
 /* vertex structure for gear geometry */
 typedef struct Vertex
 {
@@ -21,14 +54,72 @@ typedef struct Vertex
 	float normal[3];
 } Vertex;
 
-/* gear geometry data */
+/* packed VERTEX_FULL equivalent, decoded in vertex*.glsl/hlsl when built with COMPACT_VERTEX */
+typedef struct CompactVertex
+{
+	uint16_t position[4]; /* IEEE half floats, w = 1.0 */
+	int16_t normal[2];    /* octahedral-encoded unit normal */
+} CompactVertex;
+
+/* adjustable parameters of one gear mesh */
+typedef struct GearParams
+{
+	float inner_radius;
+	float outer_radius;
+	float width;
+	int teeth;
+	float tooth_depth;
+} GearParams;
+
+/* one gear mesh, as a range of RenderState.geometry */
 typedef struct GearData
+{
+	uint32_t first_index;
+	uint32_t index_count;
+	int32_t vertex_offset; /* added to every index, they're relative to the mesh's first vertex */
+} GearData;
+
+/* every gear mesh, suballocated from one vertex buffer and one index buffer that are bound once per pass */
+typedef struct GeometryPool
 {
 	SDL_GPUBuffer *vertex_buffer;
 	SDL_GPUBuffer *index_buffer;
+	uint32_t vertex_count;
 	uint32_t index_count;
-	float color[3];
-} GearData;
+	uint32_t index_size; /* bytes per index, 2 if every mesh has at most 65536 vertices, 4 otherwise */
+} GeometryPool;
+
+/* placement of every gear in the scene, as structure-of-arrays for the batched transform pass
+ * gear i is at (x[i], y[i], z[i]), rotated by (ratio[i] * angle + phase[i]) degrees around z */
+typedef struct GearLayout
+{
+	uint32_t *mesh; /* index into RenderState.gears */
+	float *x, *y, *z;
+	float *ratio;
+	float *phase;
+	float (*color)[4]; /* rgb + padding, copied straight into InstanceData */
+	uint32_t count;
+} GearLayout;
+
+/* per-instance vertex data for RENDER_INSTANCED/RENDER_PROCEDURAL, must match vertex_instanced.glsl/hlsl and vertex_procedural.glsl/hlsl */
+typedef struct InstanceData
+{
+	float mvp_matrix[16];
+	float normal_matrix[12]; /* mat3 as 3 vec4 columns */
+	float color[4];
+} InstanceData;
+
+/* most frames the cpu can get ahead of the gpu, -image_count's limit */
+#define MAX_FRAMES_IN_FLIGHT 3
+
+/* everything the cpu rewrites every frame, one copy per possible frame in flight (see sdlgpu_frames.h) */
+typedef struct FrameResources
+{
+	SDL_GPUBuffer *instance_buffer; /* InstanceData per gear, for RENDER_INSTANCED/RENDER_PROCEDURAL/RENDER_INDIRECT */
+	SDL_GPUTransferBuffer *instance_transfer_buffer;
+	SDL_GPUFence *fence; /* the last submission that used this slot, NULL once it's known to be done */
+	uint64_t serial;     /* which submission that was, counting from 0 */
+} FrameResources;
 
 /* rendering state */
 typedef struct RenderState
@@ -37,18 +128,43 @@ typedef struct RenderState
 	SDL_GPUGraphicsPipeline *pipeline;
 	SDL_GPUShader *vertex_shader;
 	SDL_GPUShader *fragment_shader;
-	SDL_GPUTexture *depth_texture;
-	uint32_t depth_texture_width;
-	uint32_t depth_texture_height;
-	GearData gears[3];
+	SDL_GPUTexture *depth_texture; /* this frame's, owned by sdlgpu_targets.h */
+	GeometryPool geometry;         /* empty for RENDER_PROCEDURAL */
+	GearData *gears;               /* meshes */
+	const GearParams *gear_params; /* shape of each mesh */
+	uint32_t num_gears;
+	GearLayout layout; /* kept grouped by mesh, so that RENDER_INSTANCED can draw each run at once */
+	float view_distance, z_far; /* sized to fit the scene */
+	SDL_GPUTexture *offscreen_texture; /* headless render target, used in place of the swapchain when there's no window */
+	uint32_t offscreen_width;
+	uint32_t offscreen_height;
+	FrameResources frames[MAX_FRAMES_IN_FLIGHT]; /* also throttles headless frames, since there's no swapchain to do it */
+	uint32_t frame_slot;                         /* the frame being recorded */
+	uint32_t frames_in_flight;
+	PresentMode present_mode; /* of the window's swapchain, VSYNC when headless */
+	double fixed_timestep; /* if > 0, animate by this many seconds per frame instead of by wall time */
+	RenderMode render_mode;
+	VertexFormat vertex_format;
+	MeshGenerator mesh_generator;
+	bool verify_meshes; /* compare MESHGEN_GPU meshes against the cpu generator after creating them */
+	bool cpu_culling;   /* only draw the gears sdlgpu_spatial.h finds in the view frustum (RENDER_INDIRECT culls on the gpu instead) */
 	float view_rotx, view_roty, view_rotz;
 	float angle;
-	bool swapchain_valid;
 	bool pause_animation;
+	uint64_t input_time; /* SDL_GetTicksNS() of the newest input, for the input-to-present latency estimate */
+	/* set while headless frames are drawn for another thread to present (see sdlgpu_render_thread.h), draw_frame() hands each one over
+	 * through this after submitting it, and what it waits for there counts as the frame's acquire wait
+	 * input_time is the input the frame is the first to show (0 if none), whose latency is then up to whoever presents it */
+	void (*publish_frame)(uint64_t input_time);
 } RenderState;
 
-/* called from main loop */
-void draw_frame(SDL_Window *window);
+/* called from main loop, renders to render_state.offscreen_texture if window is NULL, false if no frame was submitted */
+bool draw_frame(SDL_Window *window);
+
+/* by whichever thread draws: adopt the present configuration the window thread switched to (see set_present_mode()),
+ * the frame ring follows frames_in_flight, and each switch is followed by a readout of the acquire wait and input-to-present latency
+ * once the new configuration has settled */
+void apply_present_config(PresentMode present_mode, uint32_t frames_in_flight);
 
 /* global render state info */
 extern RenderState render_state;
@@ -0,0 +1,376 @@
+/*
+ * Copyright (C) 2025 William Horvath
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <SDL3/SDL_atomic.h>
+#include <SDL3/SDL_events.h>
+#include <SDL3/SDL_gpu.h>
+#include <SDL3/SDL_mutex.h>
+#include <SDL3/SDL_thread.h>
+#include <SDL3/SDL_timer.h>
+
+#include "sdlgpu_frames.h"
+#include "sdlgpu_render.h"
+#include "sdlgpu_render_thread.h"
+#include "sdlgpu_timing.h"
+#include "sdlgpu_trace.h"
+
+#define COMMAND_QUEUE_SIZE 1024 /* power of 2 */
+
+/* set in render_thread.latest while the slot there hasn't been picked up yet */
+#define INPUT_FRESH 4
+/* same for render_thread.latest_frame */
+#define FRAME_FRESH 4
+
+/* a finished frame, sized like the window was when it was drawn */
+typedef struct PresentFrame
+{
+	SDL_GPUTexture *texture;
+	uint32_t width, height;
+	uint64_t input_time; /* the input this frame is the first to show, 0 if none */
+
+	/* input_time's latency, filled in by the event thread once it has submitted the blit, and recorded by the render thread when
+	 * the frame comes back to it, since only that one has the frame timing */
+	float latency_ms;       /* input to blit submit, < 0 if there's nothing to record */
+	uint32_t frames_queued; /* blits the gpu hadn't finished by then, that one included */
+} PresentFrame;
+
+static struct
+{
+	SDL_Thread *thread;
+	SDL_Window *window;
+	SDL_Semaphore *wake; /* signaled for every command, so a paused render thread can sleep */
+	SDL_AtomicInt quit;
+
+	/* single producer (event thread), single consumer (render thread) ring */
+	RenderCommand commands[COMMAND_QUEUE_SIZE];
+	SDL_AtomicInt head, tail;
+
+	/* double-buffered input with a spare slot, so neither side ever waits for the other:
+	 * the event thread fills write_slot and swaps it into latest, the render thread swaps read_slot out of latest when it's fresh */
+	ViewInput inputs[3];
+	SDL_AtomicInt latest;
+	int write_slot; /* event thread only */
+	int read_slot;  /* render thread only */
+
+	/* finished frames the same way in the other direction: the render thread draws into draw_slot and swaps it into latest_frame,
+	 * the event thread swaps present_slot out of it when it's fresh, after submitting the blit of its previous one
+	 * so by the time the render thread gets a frame back, the gpu has been handed everything that reads it */
+	PresentFrame frames[3];
+	SDL_GPUTextureFormat format; /* the swapchain's, so the pipeline works for both */
+	SDL_AtomicInt latest_frame;
+	int draw_slot;              /* render thread only */
+	int present_slot;           /* event thread only */
+	SDL_Semaphore *presented;   /* signaled whenever the event thread has presented a frame */
+	Uint32 frame_event;         /* pushed to the event thread for every finished frame */
+
+	/* the last blits, the swapchain never lets more than MAX_FRAMES_IN_FLIGHT of them be pending, event thread only */
+	SDL_GPUFence *blit_fences[MAX_FRAMES_IN_FLIGHT];
+	uint32_t next_blit;
+} render_thread;
+
+void apply_view_input(const ViewInput *input)
+{
+	render_state.view_rotx = input->view_rotx;
+	render_state.view_roty = input->view_roty;
+	render_state.view_rotz = input->view_rotz;
+	render_state.pause_animation = input->pause_animation;
+	render_state.input_time = input->input_time;
+	apply_present_config(input->present_mode, input->frames_in_flight);
+}
+
+static bool pop_command(RenderCommand *command)
+{
+	int head = SDL_GetAtomicInt(&render_thread.head);
+	if (head == SDL_GetAtomicInt(&render_thread.tail))
+		return false;
+
+	*command = render_thread.commands[(unsigned int)head % COMMAND_QUEUE_SIZE];
+	SDL_SetAtomicInt(&render_thread.head, head + 1);
+	return true;
+}
+
+/* point the headless path of draw_frame() at the frame being drawn, at the window's current size */
+static bool prepare_frame(const ViewInput *input)
+{
+	PresentFrame *frame = &render_thread.frames[render_thread.draw_slot];
+	uint32_t width = (uint32_t)SDL_max(input->width, 1);
+	uint32_t height = (uint32_t)SDL_max(input->height, 1);
+
+	if (!frame->texture || frame->width != width || frame->height != height)
+	{
+		retire_texture(frame->texture);
+
+		SDL_GPUTextureCreateInfo info = {.type = SDL_GPU_TEXTURETYPE_2D,
+		                                 .format = render_thread.format,
+		                                 .usage = SDL_GPU_TEXTUREUSAGE_COLOR_TARGET | SDL_GPU_TEXTUREUSAGE_SAMPLER,
+		                                 .width = width,
+		                                 .height = height,
+		                                 .layer_count_or_depth = 1,
+		                                 .num_levels = 1,
+		                                 .sample_count = SDL_GPU_SAMPLECOUNT_1,
+		                                 .props = 0};
+
+		/* keeps a latency the event thread left here */
+		frame->texture = SDL_CreateGPUTexture(render_state.device, &info);
+		frame->width = width;
+		frame->height = height;
+		if (!frame->texture)
+		{
+			printf("Failed to create %ux%u render thread frame: %s\n", width, height, SDL_GetError());
+			return false;
+		}
+	}
+
+	render_state.offscreen_texture = frame->texture;
+	render_state.offscreen_width = width;
+	render_state.offscreen_height = height;
+	return true;
+}
+
+/* render_state.publish_frame: hand the frame just drawn to the event thread, once it has taken the previous one */
+static void publish_frame(uint64_t input_time)
+{
+	render_thread.frames[render_thread.draw_slot].input_time = input_time;
+
+	trace_begin("wait_for_present");
+	while ((SDL_GetAtomicInt(&render_thread.latest_frame) & FRAME_FRESH) && !SDL_GetAtomicInt(&render_thread.quit))
+		SDL_WaitSemaphore(render_thread.presented);
+	trace_end("wait_for_present");
+
+	render_thread.draw_slot = SDL_SetAtomicInt(&render_thread.latest_frame, render_thread.draw_slot | FRAME_FRESH) & ~FRAME_FRESH;
+
+	/* attributed to the frame being handed over rather than the one that showed the input, which only matters across timing windows */
+	PresentFrame *returned = &render_thread.frames[render_thread.draw_slot];
+	if (returned->latency_ms >= 0.0f)
+	{
+		timing_input_latency(returned->latency_ms, returned->frames_queued);
+		returned->latency_ms = -1.0f;
+	}
+
+	SDL_Event event;
+	memset(&event, 0, sizeof(event));
+	event.type = render_thread.frame_event;
+	SDL_PushEvent(&event);
+}
+
+static int SDLCALL render_thread_main(void *data)
+{
+	(void)data;
+
+	while (!SDL_GetAtomicInt(&render_thread.quit))
+	{
+		/* drain the wakeups before the queue, so a command pushed after the check below still wakes us up */
+		while (SDL_TryWaitSemaphore(render_thread.wake))
+			;
+
+		bool redraw = false;
+		RenderCommand command;
+		while (pop_command(&command))
+			redraw = true;
+
+		if (SDL_GetAtomicInt(&render_thread.latest) & INPUT_FRESH)
+			render_thread.read_slot = SDL_SetAtomicInt(&render_thread.latest, render_thread.read_slot) & ~INPUT_FRESH;
+		const ViewInput *input = &render_thread.inputs[render_thread.read_slot];
+		apply_view_input(input);
+
+		/* like the single-threaded loop, a paused scene is only redrawn when something happens */
+		if (render_state.pause_animation && !redraw)
+		{
+			trace_begin("render_thread_wait");
+			SDL_WaitSemaphore(render_thread.wake);
+			trace_end("render_thread_wait");
+			continue;
+		}
+
+		/* never the swapchain, see sdlgpu_render_thread.h, draw_frame() calls publish_frame() once it's submitted */
+		if (prepare_frame(input))
+			draw_frame(NULL);
+	}
+
+	return 0;
+}
+
+static void release_frames(void)
+{
+	for (int i = 0; i < 3; i++)
+	{
+		if (render_thread.frames[i].texture)
+			SDL_ReleaseGPUTexture(render_state.device, render_thread.frames[i].texture);
+	}
+	memset(render_thread.frames, 0, sizeof(render_thread.frames));
+
+	/* that was one of the above */
+	render_state.offscreen_texture = NULL;
+
+	for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+	{
+		if (render_thread.blit_fences[i])
+			SDL_ReleaseGPUFence(render_state.device, render_thread.blit_fences[i]);
+		render_thread.blit_fences[i] = NULL;
+	}
+}
+
+bool render_thread_start(SDL_Window *window, const ViewInput *input)
+{
+	render_thread.window = window;
+	render_thread.format = SDL_GetGPUSwapchainTextureFormat(render_state.device, window);
+	render_thread.frame_event = SDL_RegisterEvents(1);
+	render_thread.wake = SDL_CreateSemaphore(0);
+	render_thread.presented = SDL_CreateSemaphore(0);
+	if (!render_thread.frame_event || !render_thread.wake || !render_thread.presented)
+	{
+		printf("Failed to set up the render thread: %s\n", SDL_GetError());
+		if (render_thread.wake)
+			SDL_DestroySemaphore(render_thread.wake);
+		if (render_thread.presented)
+			SDL_DestroySemaphore(render_thread.presented);
+		render_thread.wake = render_thread.presented = NULL;
+		return false;
+	}
+
+	SDL_SetAtomicInt(&render_thread.quit, 0);
+	SDL_SetAtomicInt(&render_thread.head, 0);
+	SDL_SetAtomicInt(&render_thread.tail, 0);
+
+	render_thread.inputs[0] = *input;
+	render_thread.read_slot = 0;
+	render_thread.write_slot = 1;
+	SDL_SetAtomicInt(&render_thread.latest, 2);
+
+	render_thread.draw_slot = 0;
+	render_thread.present_slot = 1;
+	for (int i = 0; i < 3; i++)
+		render_thread.frames[i].latency_ms = -1.0f;
+	SDL_SetAtomicInt(&render_thread.latest_frame, 2);
+	render_state.publish_frame = publish_frame;
+
+	render_thread.thread = SDL_CreateThread(render_thread_main, "render", NULL);
+	if (!render_thread.thread)
+	{
+		printf("Failed to start render thread: %s\n", SDL_GetError());
+		render_state.publish_frame = NULL;
+		SDL_DestroySemaphore(render_thread.wake);
+		SDL_DestroySemaphore(render_thread.presented);
+		render_thread.wake = render_thread.presented = NULL;
+		return false;
+	}
+
+	return true;
+}
+
+void render_thread_stop(void)
+{
+	if (!render_thread.thread)
+		return;
+
+	SDL_SetAtomicInt(&render_thread.quit, 1);
+	SDL_SignalSemaphore(render_thread.wake);
+	SDL_SignalSemaphore(render_thread.presented);
+	SDL_WaitThread(render_thread.thread, NULL);
+	render_state.publish_frame = NULL;
+	SDL_DestroySemaphore(render_thread.wake);
+	SDL_DestroySemaphore(render_thread.presented);
+
+	/* the last blits may still be reading them */
+	SDL_WaitForGPUIdle(render_state.device);
+	release_frames();
+
+	render_thread.thread = NULL;
+	render_thread.wake = render_thread.presented = NULL;
+}
+
+void render_thread_set_input(const ViewInput *input)
+{
+	render_thread.inputs[render_thread.write_slot] = *input;
+	render_thread.write_slot = SDL_SetAtomicInt(&render_thread.latest, render_thread.write_slot | INPUT_FRESH) & ~INPUT_FRESH;
+}
+
+void render_thread_send(RenderCommand command)
+{
+	int tail = SDL_GetAtomicInt(&render_thread.tail);
+
+	/* the queue only fills up if the render thread is stuck for a thousand events, every one of which has already woken it up */
+	while (tail - SDL_GetAtomicInt(&render_thread.head) >= COMMAND_QUEUE_SIZE)
+		SDL_Delay(1);
+
+	render_thread.commands[(unsigned int)tail % COMMAND_QUEUE_SIZE] = command;
+	SDL_SetAtomicInt(&render_thread.tail, tail + 1);
+	SDL_SignalSemaphore(render_thread.wake);
+}
+
+/* blit the frame into the swapchain, which has to happen on the thread that created the window */
+static void present_frame(PresentFrame *frame)
+{
+	SDL_GPUCommandBuffer *cmd = SDL_AcquireGPUCommandBuffer(render_state.device);
+	if (!cmd)
+		return;
+
+	SDL_GPUTexture *swapchain_texture = NULL;
+	uint32_t w = 0, h = 0;
+	trace_begin("wait_and_acquire_swapchain");
+	bool acquired = SDL_WaitAndAcquireGPUSwapchainTexture(cmd, render_thread.window, &swapchain_texture, &w, &h);
+	trace_end("wait_and_acquire_swapchain");
+	if (!acquired)
+	{
+		SDL_CancelGPUCommandBuffer(cmd);
+		return;
+	}
+
+	/* no texture while minimized, and a frame drawn just before a resize gets stretched to the new size */
+	if (swapchain_texture)
+	{
+		SDL_GPUBlitInfo blit = {.source = {.texture = frame->texture, .mip_level = 0, .layer_or_depth_plane = 0, .x = 0, .y = 0, .w = frame->width, .h = frame->height},
+		                        .destination = {.texture = swapchain_texture, .mip_level = 0, .layer_or_depth_plane = 0, .x = 0, .y = 0, .w = w, .h = h},
+		                        .load_op = SDL_GPU_LOADOP_DONT_CARE,
+		                        .clear_color = {0.0f, 0.0f, 0.0f, 1.0f},
+		                        .flip_mode = SDL_FLIP_NONE,
+		                        .filter = SDL_GPU_FILTER_LINEAR,
+		                        .cycle = false};
+		SDL_BlitGPUTexture(cmd, &blit);
+	}
+
+	/* with a fence, so the latency estimate can count the blits still queued up like draw_frame() counts its frames */
+	SDL_GPUFence **fence = &render_thread.blit_fences[render_thread.next_blit];
+	render_thread.next_blit = (render_thread.next_blit + 1) % MAX_FRAMES_IN_FLIGHT;
+	if (*fence)
+		SDL_ReleaseGPUFence(render_state.device, *fence);
+	*fence = SDL_SubmitGPUCommandBufferAndAcquireFence(cmd);
+
+	if (frame->input_time && swapchain_texture)
+	{
+		uint32_t queued = 0;
+		for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+		{
+			if (render_thread.blit_fences[i] && !SDL_QueryGPUFence(render_state.device, render_thread.blit_fences[i]))
+				queued++;
+		}
+
+		frame->latency_ms = (float)((double)(SDL_GetTicksNS() - frame->input_time) / (double)SDL_NS_PER_MS);
+		frame->frames_queued = queued;
+	}
+	frame->input_time = 0;
+}
+
+bool render_thread_handle_event(const SDL_Event *event)
+{
+	if (!render_thread.thread || event->type != render_thread.frame_event)
+		return false;
+
+	/* a frame event can outlive the frame it announced if this thread fell behind, the newest one was presented instead */
+	if (SDL_GetAtomicInt(&render_thread.latest_frame) & FRAME_FRESH)
+	{
+		trace_begin("present");
+		render_thread.present_slot = SDL_SetAtomicInt(&render_thread.latest_frame, render_thread.present_slot) & ~FRAME_FRESH;
+		present_frame(&render_thread.frames[render_thread.present_slot]);
+		trace_end("present");
+
+		/* only now, so the swapchain's throttling reaches the render thread */
+		SDL_SignalSemaphore(render_thread.presented);
+	}
+
+	return true;
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2025 William Horvath
+ */
+
+#pragma once
+#include <stdbool.h>
+
+#include <stdint.h>
+
+#include "sdlgpu_render.h"
+
+typedef struct SDL_Window SDL_Window;
+typedef union SDL_Event SDL_Event;
+
+/* the part of RenderState that input drives, owned by the event thread while the render thread runs */
+typedef struct ViewInput
+{
+	float view_rotx, view_roty, view_rotz;
+	bool pause_animation;
+	uint64_t input_time;       /* event timestamp of the newest key press */
+	PresentMode present_mode;  /* what the event thread switched the swapchain to, see set_present_mode() */
+	uint32_t frames_in_flight; /* ditto, set_frames_in_flight() */
+	int width, height;         /* window size in pixels, what the render thread draws at */
+} ViewInput;
+
+/* one-off requests from the event thread, everything stateful goes through ViewInput instead */
+typedef enum RenderCommand
+{
+	RENDER_CMD_REDRAW /* draw a frame even when paused */
+} RenderCommand;
+
+/* copy input into render_state, for whichever thread is drawing */
+void apply_view_input(const ViewInput *input);
+
+/* run draw_frame() on its own thread until render_thread_stop(), nothing else may touch render_state in between
+ * SDL only allows swapchain acquisition and presentation (and anything else that touches the swapchain) on the thread that created
+ * the window, so the render thread draws headless into frames of its own, and the event thread presents them: it acquires the
+ * swapchain, blits the newest finished frame into it and submits, every time render_thread_handle_event() sees one come in
+ * at most one finished frame waits for the event thread, so the swapchain's own throttling still paces the render thread
+ * (that wait is the frame's acquire wait), and input-to-present latency is estimated from when the event thread submits the blit */
+bool render_thread_start(SDL_Window *window, const ViewInput *input);
+void render_thread_stop(void);
+
+/* event thread only: publish the latest input, picked up at the start of the next frame */
+void render_thread_set_input(const ViewInput *input);
+/* event thread only: queue a command, handled at the start of the next frame */
+void render_thread_send(RenderCommand command);
+/* event thread only: true if event was the render thread announcing a finished frame, which has then been presented */
+bool render_thread_handle_event(const SDL_Event *event);
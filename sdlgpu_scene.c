@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 1999-2001  Brian Paul        All Rights Reserved. (For gear placement)
+ * Copyright (C) 2025       William Horvath   All Rights Reserved.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <SDL3/SDL_gpu.h>
+
+#include "sdlgpu_gear_compute.h"
+#include "sdlgpu_gear_creation.h"
+#include "sdlgpu_render.h"
+#include "sdlgpu_scene.h"
+#include "sdlgpu_trace.h"
+
+#define NUM_MESHES 3
+
+/* the original glxgears meshes */
+static const GearParams meshes[NUM_MESHES] = {{.inner_radius = 1.0f, .outer_radius = 4.0f, .width = 1.0f, .teeth = 20, .tooth_depth = 0.7f},
+                                              {.inner_radius = 0.5f, .outer_radius = 2.0f, .width = 2.0f, .teeth = 10, .tooth_depth = 0.7f},
+                                              {.inner_radius = 1.3f, .outer_radius = 2.0f, .width = 0.5f, .teeth = 10, .tooth_depth = 0.7f}};
+
+/* the original glxgears trio, which meshes correctly (20 teeth driving two 10 tooth gears at -2x) */
+static const struct
+{
+	uint32_t mesh;
+	float x, y, z;
+	float ratio;
+	float phase;
+	float color[3];
+} trio[NUM_MESHES] = {{.mesh = 0, .x = -3.0f, .y = -2.0f, .z = 0.0f, .ratio = 1.0f, .phase = 0.0f, .color = {0.8f, 0.1f, 0.0f}},
+                      {.mesh = 1, .x = 3.1f, .y = -2.0f, .z = 0.0f, .ratio = -2.0f, .phase = -9.0f, .color = {0.0f, 0.8f, 0.2f}},
+                      {.mesh = 2, .x = -3.1f, .y = 4.2f, .z = 0.0f, .ratio = -2.0f, .phase = -25.0f, .color = {0.2f, 0.2f, 1.0f}}};
+
+/* distance between trio origins in the grid, the trio spans about 13x13 units */
+#define TRIO_SPACING 14.0f
+
+/* all arrays come from one allocation, owned by layout->color */
+static bool alloc_layout(GearLayout *layout, uint32_t count)
+{
+	/* every array starts 16 byte aligned */
+	size_t stride = ((size_t)count + 3) & ~(size_t)3;
+	unsigned char *block = (unsigned char *)SDL_aligned_alloc(16, stride * (4 * sizeof(float) + 5 * sizeof(float) + sizeof(uint32_t)));
+	if (!block)
+		return false;
+
+	layout->color = (float(*)[4])block;
+	layout->x = (float *)(block + stride * 4 * sizeof(float));
+	layout->y = layout->x + stride;
+	layout->z = layout->y + stride;
+	layout->ratio = layout->z + stride;
+	layout->phase = layout->ratio + stride;
+	layout->mesh = (uint32_t *)(layout->phase + stride);
+	layout->count = 0;
+	return true;
+}
+
+bool create_scene(SDL_GPUDevice *device, unsigned int num_gears)
+{
+	if (num_gears < 1)
+		num_gears = 1;
+
+	render_state.gears = (GearData *)calloc(NUM_MESHES, sizeof(GearData));
+	if (!render_state.gears || !alloc_layout(&render_state.layout, num_gears))
+	{
+		printf("Failed to allocate scene for %u gears\n", num_gears);
+		return false;
+	}
+	render_state.num_gears = NUM_MESHES;
+
+	render_state.gear_params = meshes;
+
+	/* RENDER_PROCEDURAL builds the meshes in the vertex shader, so there's nothing to upload */
+	SDL_GPUFence *upload_fence = NULL;
+	if (render_state.render_mode == RENDER_PROCEDURAL)
+	{
+		for (int m = 0; m < NUM_MESHES; m++)
+			render_state.gears[m] = (GearData){.first_index = 0, .index_count = gear_index_count(meshes[m].teeth), .vertex_offset = 0};
+	}
+	else if (render_state.mesh_generator == MESHGEN_GPU)
+	{
+		trace_begin("create_gears_gpu");
+		bool created = create_gears_gpu(device, &render_state.geometry, render_state.gears, meshes, NUM_MESHES, &upload_fence);
+		trace_end("create_gears_gpu");
+
+		if (!created)
+		{
+			printf("Failed to generate gear geometry on the GPU\n");
+			return false;
+		}
+	}
+	else
+	{
+		trace_begin("create_gears");
+		bool created = create_gears(device, &render_state.geometry, render_state.gears, meshes, NUM_MESHES, &upload_fence);
+		trace_end("create_gears");
+
+		if (!created)
+		{
+			printf("Failed to create gear geometry\n");
+			return false;
+		}
+	}
+
+	/* lay out a square grid of trios, the last one may be incomplete */
+	unsigned int num_trios = (num_gears + NUM_MESHES - 1) / NUM_MESHES;
+	unsigned int columns = (unsigned int)ceil(sqrt((double)num_trios));
+	unsigned int rows = (num_trios + columns - 1) / columns;
+
+	float origin_x = -0.5f * (float)(columns - 1) * TRIO_SPACING;
+	float origin_y = -0.5f * (float)(rows - 1) * TRIO_SPACING;
+
+	/* keep gears grouped by mesh for RENDER_INSTANCED/RENDER_PROCEDURAL/RENDER_INDIRECT */
+	GearLayout *layout = &render_state.layout;
+	uint32_t count = 0;
+	for (int m = 0; m < NUM_MESHES; m++)
+	{
+		for (unsigned int t = 0; t < num_trios; t++)
+		{
+			if (t * NUM_MESHES + m >= num_gears)
+				break;
+
+			layout->mesh[count] = trio[m].mesh;
+			layout->x[count] = trio[m].x + origin_x + (float)(t % columns) * TRIO_SPACING;
+			layout->y[count] = trio[m].y + origin_y + (float)(t / columns) * TRIO_SPACING;
+			layout->z[count] = trio[m].z;
+			layout->ratio[count] = trio[m].ratio;
+			layout->phase[count] = trio[m].phase;
+			layout->color[count][0] = trio[m].color[0];
+			layout->color[count][1] = trio[m].color[1];
+			layout->color[count][2] = trio[m].color[2];
+			layout->color[count][3] = 0.0f; /* padding */
+			count++;
+		}
+	}
+	layout->count = count;
+
+	/* pull the camera back far enough to fit the whole grid (the frustum is +-0.2 wide per unit of depth) */
+	float radius = 0.75f * (float)SDL_max(columns, rows) * TRIO_SPACING;
+	if (num_trios <= 1)
+	{
+		render_state.view_distance = 40.0f;
+		render_state.z_far = 60.0f;
+	}
+	else
+	{
+		render_state.view_distance = SDL_max(40.0f, radius * 5.5f);
+		render_state.z_far = render_state.view_distance + radius + 20.0f;
+	}
+
+	/* the layout above overlaps with the mesh upload */
+	if (upload_fence)
+	{
+		trace_begin("create_gears_wait");
+		SDL_WaitForGPUFences(device, true, &upload_fence, 1);
+		SDL_ReleaseGPUFence(device, upload_fence);
+		trace_end("create_gears_wait");
+	}
+
+	if (render_state.render_mode != RENDER_PROCEDURAL && render_state.mesh_generator == MESHGEN_GPU && render_state.verify_meshes &&
+	    !verify_gears_gpu(device, &render_state.geometry, render_state.gears, meshes, NUM_MESHES))
+	{
+		printf("GPU gear meshes don't match the CPU reference\n");
+		return false;
+	}
+
+	return true;
+}
+
+void destroy_scene(SDL_GPUDevice *device)
+{
+	if (render_state.geometry.vertex_buffer)
+		SDL_ReleaseGPUBuffer(device, render_state.geometry.vertex_buffer);
+	if (render_state.geometry.index_buffer)
+		SDL_ReleaseGPUBuffer(device, render_state.geometry.index_buffer);
+	memset(&render_state.geometry, 0, sizeof(render_state.geometry));
+
+	free(render_state.gears);
+	SDL_aligned_free(render_state.layout.color);
+
+	render_state.gears = NULL;
+	render_state.gear_params = NULL;
+	render_state.num_gears = 0;
+	memset(&render_state.layout, 0, sizeof(render_state.layout));
+}
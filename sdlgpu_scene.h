@@ -0,0 +1,12 @@
+/*
+ * Copyright (C) 2025 William Horvath
+ */
+
+#pragma once
+#include <stdbool.h>
+
+typedef struct SDL_GPUDevice SDL_GPUDevice;
+
+/* create the gear meshes and lay out num_gears gears in render_state (3 is the classic glxgears scene) */
+bool create_scene(SDL_GPUDevice *device, unsigned int num_gears);
+void destroy_scene(SDL_GPUDevice *device);
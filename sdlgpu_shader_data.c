@@ -54,6 +54,24 @@ const unsigned char vsh_spv[] = {
 const unsigned char fsh_spv[] = {
 #embed "fragment.spv"
 };
+const unsigned char vsh_inst_spv[] = {
+#embed "vertex_instanced.spv"
+};
+const unsigned char vsh_compact_spv[] = {
+#embed "vertex_compact.spv"
+};
+const unsigned char vsh_inst_compact_spv[] = {
+#embed "vertex_instanced_compact.spv"
+};
+const unsigned char vsh_proc_spv[] = {
+#embed "vertex_procedural.spv"
+};
+const unsigned char csh_gears_spv[] = {
+#embed "compute_gears.spv"
+};
+const unsigned char csh_cull_spv[] = {
+#embed "cull_gears.spv"
+};
 unsigned long long vsh_spv_size(void)
 {
 	return sizeof(vsh_spv);
@@ -62,15 +80,51 @@ unsigned long long fsh_spv_size(void)
 {
 	return sizeof(fsh_spv);
 }
+unsigned long long vsh_inst_spv_size(void)
+{
+	return sizeof(vsh_inst_spv);
+}
+unsigned long long vsh_compact_spv_size(void)
+{
+	return sizeof(vsh_compact_spv);
+}
+unsigned long long vsh_inst_compact_spv_size(void)
+{
+	return sizeof(vsh_inst_compact_spv);
+}
+unsigned long long vsh_proc_spv_size(void)
+{
+	return sizeof(vsh_proc_spv);
+}
+unsigned long long csh_gears_spv_size(void)
+{
+	return sizeof(csh_gears_spv);
+}
+unsigned long long csh_cull_spv_size(void)
+{
+	return sizeof(csh_cull_spv);
+}
 #else  /* HAVE_GNU_ASSEMBLER */
 INCBIN_("vertex.spv", vsh_spv);
 INCBIN_("fragment.spv", fsh_spv);
+INCBIN_("vertex_instanced.spv", vsh_inst_spv);
+INCBIN_("vertex_compact.spv", vsh_compact_spv);
+INCBIN_("vertex_instanced_compact.spv", vsh_inst_compact_spv);
+INCBIN_("vertex_procedural.spv", vsh_proc_spv);
+INCBIN_("compute_gears.spv", csh_gears_spv);
+INCBIN_("cull_gears.spv", csh_cull_spv);
 /* clang-format off */
 #ifdef __cplusplus
 extern "C" {
 #endif
 extern const unsigned char vsh_spv_end[];
 extern const unsigned char fsh_spv_end[];
+extern const unsigned char vsh_inst_spv_end[];
+extern const unsigned char vsh_compact_spv_end[];
+extern const unsigned char vsh_inst_compact_spv_end[];
+extern const unsigned char vsh_proc_spv_end[];
+extern const unsigned char csh_gears_spv_end[];
+extern const unsigned char csh_cull_spv_end[];
 #ifdef __cplusplus
 }
 #endif
@@ -83,6 +137,30 @@ unsigned long long fsh_spv_size(void)
 {
 	return &fsh_spv_end[0] - &fsh_spv[0];
 }
+unsigned long long vsh_inst_spv_size(void)
+{
+	return &vsh_inst_spv_end[0] - &vsh_inst_spv[0];
+}
+unsigned long long vsh_compact_spv_size(void)
+{
+	return &vsh_compact_spv_end[0] - &vsh_compact_spv[0];
+}
+unsigned long long vsh_inst_compact_spv_size(void)
+{
+	return &vsh_inst_compact_spv_end[0] - &vsh_inst_compact_spv[0];
+}
+unsigned long long vsh_proc_spv_size(void)
+{
+	return &vsh_proc_spv_end[0] - &vsh_proc_spv[0];
+}
+unsigned long long csh_gears_spv_size(void)
+{
+	return &csh_gears_spv_end[0] - &csh_gears_spv[0];
+}
+unsigned long long csh_cull_spv_size(void)
+{
+	return &csh_cull_spv_end[0] - &csh_cull_spv[0];
+}
 #endif /* HAVE_EMBED || HAVE_GNU_ASSEMBLER */
 
 /* DXIL/D3D12 shaders, Windows-only */
@@ -94,6 +172,24 @@ const unsigned char vsh_dx[] = {
 const unsigned char fsh_dx[] = {
 #embed "fragment.dxil"
 };
+const unsigned char vsh_inst_dx[] = {
+#embed "vertex_instanced.dxil"
+};
+const unsigned char vsh_compact_dx[] = {
+#embed "vertex_compact.dxil"
+};
+const unsigned char vsh_inst_compact_dx[] = {
+#embed "vertex_instanced_compact.dxil"
+};
+const unsigned char vsh_proc_dx[] = {
+#embed "vertex_procedural.dxil"
+};
+const unsigned char csh_gears_dx[] = {
+#embed "compute_gears.dxil"
+};
+const unsigned char csh_cull_dx[] = {
+#embed "cull_gears.dxil"
+};
 unsigned long long vsh_dx_size(void)
 {
 	return sizeof(vsh_dx);
@@ -102,15 +198,51 @@ unsigned long long fsh_dx_size(void)
 {
 	return sizeof(fsh_dx);
 }
+unsigned long long vsh_inst_dx_size(void)
+{
+	return sizeof(vsh_inst_dx);
+}
+unsigned long long vsh_compact_dx_size(void)
+{
+	return sizeof(vsh_compact_dx);
+}
+unsigned long long vsh_inst_compact_dx_size(void)
+{
+	return sizeof(vsh_inst_compact_dx);
+}
+unsigned long long vsh_proc_dx_size(void)
+{
+	return sizeof(vsh_proc_dx);
+}
+unsigned long long csh_gears_dx_size(void)
+{
+	return sizeof(csh_gears_dx);
+}
+unsigned long long csh_cull_dx_size(void)
+{
+	return sizeof(csh_cull_dx);
+}
 #else
 INCBIN_("vertex.dxil", vsh_dx);
 INCBIN_("fragment.dxil", fsh_dx);
+INCBIN_("vertex_instanced.dxil", vsh_inst_dx);
+INCBIN_("vertex_compact.dxil", vsh_compact_dx);
+INCBIN_("vertex_instanced_compact.dxil", vsh_inst_compact_dx);
+INCBIN_("vertex_procedural.dxil", vsh_proc_dx);
+INCBIN_("compute_gears.dxil", csh_gears_dx);
+INCBIN_("cull_gears.dxil", csh_cull_dx);
 /* clang-format off */
 #ifdef __cplusplus
 extern "C" {
 #endif
 extern const unsigned char vsh_dx_end[];
 extern const unsigned char fsh_dx_end[];
+extern const unsigned char vsh_inst_dx_end[];
+extern const unsigned char vsh_compact_dx_end[];
+extern const unsigned char vsh_inst_compact_dx_end[];
+extern const unsigned char vsh_proc_dx_end[];
+extern const unsigned char csh_gears_dx_end[];
+extern const unsigned char csh_cull_dx_end[];
 #ifdef __cplusplus
 }
 #endif
@@ -123,11 +255,41 @@ unsigned long long fsh_dx_size(void)
 {
 	return &fsh_dx_end[0] - &fsh_dx[0];
 }
+unsigned long long vsh_inst_dx_size(void)
+{
+	return &vsh_inst_dx_end[0] - &vsh_inst_dx[0];
+}
+unsigned long long vsh_compact_dx_size(void)
+{
+	return &vsh_compact_dx_end[0] - &vsh_compact_dx[0];
+}
+unsigned long long vsh_inst_compact_dx_size(void)
+{
+	return &vsh_inst_compact_dx_end[0] - &vsh_inst_compact_dx[0];
+}
+unsigned long long vsh_proc_dx_size(void)
+{
+	return &vsh_proc_dx_end[0] - &vsh_proc_dx[0];
+}
+unsigned long long csh_gears_dx_size(void)
+{
+	return &csh_gears_dx_end[0] - &csh_gears_dx[0];
+}
+unsigned long long csh_cull_dx_size(void)
+{
+	return &csh_cull_dx_end[0] - &csh_cull_dx[0];
+}
 #endif
 #else
 /* dummy defines for platforms without D3D12 support */
 const unsigned char vsh_dx[] = {(unsigned char)0};
 const unsigned char fsh_dx[] = {(unsigned char)0};
+const unsigned char vsh_inst_dx[] = {(unsigned char)0};
+const unsigned char vsh_compact_dx[] = {(unsigned char)0};
+const unsigned char vsh_inst_compact_dx[] = {(unsigned char)0};
+const unsigned char vsh_proc_dx[] = {(unsigned char)0};
+const unsigned char csh_gears_dx[] = {(unsigned char)0};
+const unsigned char csh_cull_dx[] = {(unsigned char)0};
 unsigned long long vsh_dx_size(void)
 {
 	return 0;
@@ -136,4 +298,28 @@ unsigned long long fsh_dx_size(void)
 {
 	return 0;
 }
+unsigned long long vsh_inst_dx_size(void)
+{
+	return 0;
+}
+unsigned long long vsh_compact_dx_size(void)
+{
+	return 0;
+}
+unsigned long long vsh_inst_compact_dx_size(void)
+{
+	return 0;
+}
+unsigned long long vsh_proc_dx_size(void)
+{
+	return 0;
+}
+unsigned long long csh_gears_dx_size(void)
+{
+	return 0;
+}
+unsigned long long csh_cull_dx_size(void)
+{
+	return 0;
+}
 #endif /* _WIN32 */
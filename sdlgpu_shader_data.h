@@ -12,14 +12,38 @@ extern "C"
 /* precompiled shaders, included as binary data in the executable */
 extern const unsigned char vsh_spv[];
 extern const unsigned char fsh_spv[];
+extern const unsigned char vsh_inst_spv[];
+extern const unsigned char vsh_compact_spv[];
+extern const unsigned char vsh_inst_compact_spv[];
+extern const unsigned char vsh_proc_spv[];
+extern const unsigned char csh_gears_spv[];
+extern const unsigned char csh_cull_spv[];
 unsigned long long vsh_spv_size(void);
 unsigned long long fsh_spv_size(void);
+unsigned long long vsh_inst_spv_size(void);
+unsigned long long vsh_compact_spv_size(void);
+unsigned long long vsh_inst_compact_spv_size(void);
+unsigned long long vsh_proc_spv_size(void);
+unsigned long long csh_gears_spv_size(void);
+unsigned long long csh_cull_spv_size(void);
 
 /* Windows builds can use either Vulkan or D3D12 */
 extern const unsigned char vsh_dx[];
 extern const unsigned char fsh_dx[];
+extern const unsigned char vsh_inst_dx[];
+extern const unsigned char vsh_compact_dx[];
+extern const unsigned char vsh_inst_compact_dx[];
+extern const unsigned char vsh_proc_dx[];
+extern const unsigned char csh_gears_dx[];
+extern const unsigned char csh_cull_dx[];
 unsigned long long vsh_dx_size(void);
 unsigned long long fsh_dx_size(void);
+unsigned long long vsh_inst_dx_size(void);
+unsigned long long vsh_compact_dx_size(void);
+unsigned long long vsh_inst_compact_dx_size(void);
+unsigned long long vsh_proc_dx_size(void);
+unsigned long long csh_gears_dx_size(void);
+unsigned long long csh_cull_dx_size(void);
 
 #ifdef __cplusplus
 }
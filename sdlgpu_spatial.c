@@ -0,0 +1,400 @@
+/*
+ * Copyright (C) 2025 William Horvath
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <SDL3/SDL_stdinc.h>
+
+#include "sdlgpu_gear_creation.h"
+#include "sdlgpu_render.h"
+#include "sdlgpu_spatial.h"
+
+/* about this many gears per cell, a trio spans one or two cells at the default spacing */
+#define GEARS_PER_CELL 8
+#define MAX_GRID_SIZE 1024 /* cells per side */
+
+#define NO_CELL UINT32_MAX
+
+static struct
+{
+	const GearLayout *layout;
+	const GearParams *meshes;
+
+	float origin[2]; /* xy of the corner of cell 0 */
+	float inv_cell_size;
+	uint32_t columns, rows;
+	int32_t *cell_first;     /* first gear of each cell's list, -1 if empty */
+	float (*cell_bounds)[6]; /* min xyz, max xyz of the spheres ever binned in the cell, only shrinks on a rebuild */
+
+	/* per gear, capacity of each */
+	int32_t *next, *prev; /* links of the cell list, -1 at either end */
+	uint32_t *cell;       /* NO_CELL if not indexed */
+	float *radius;
+	uint32_t *visible; /* spatial_query_frustum() result */
+	uint8_t *in_view;  /* spatial_query_frustum() marks, all 0 in between */
+	uint32_t capacity;
+
+	float max_radius;
+} spatial;
+
+static uint32_t cell_coord(float v, float origin, uint32_t size)
+{
+	float c = floorf((v - origin) * spatial.inv_cell_size);
+	return c <= 0.0f ? 0 : (c >= (float)(size - 1) ? size - 1 : (uint32_t)c);
+}
+
+static uint32_t cell_of(float x, float y)
+{
+	return cell_coord(y, spatial.origin[1], spatial.rows) * spatial.columns + cell_coord(x, spatial.origin[0], spatial.columns);
+}
+
+static bool reserve_gears(uint32_t count)
+{
+	if (count <= spatial.capacity)
+		return true;
+
+	uint32_t capacity = SDL_max(count, spatial.capacity * 2);
+
+	int32_t *next = (int32_t *)realloc(spatial.next, capacity * sizeof(int32_t));
+	if (next)
+		spatial.next = next;
+	int32_t *prev = (int32_t *)realloc(spatial.prev, capacity * sizeof(int32_t));
+	if (prev)
+		spatial.prev = prev;
+	uint32_t *cell = (uint32_t *)realloc(spatial.cell, capacity * sizeof(uint32_t));
+	if (cell)
+		spatial.cell = cell;
+	float *radius = (float *)realloc(spatial.radius, capacity * sizeof(float));
+	if (radius)
+		spatial.radius = radius;
+	uint32_t *visible = (uint32_t *)realloc(spatial.visible, capacity * sizeof(uint32_t));
+	if (visible)
+		spatial.visible = visible;
+	uint8_t *in_view = (uint8_t *)realloc(spatial.in_view, capacity * sizeof(uint8_t));
+	if (in_view)
+		spatial.in_view = in_view;
+
+	if (!next || !prev || !cell || !radius || !visible || !in_view)
+	{
+		printf("Failed to grow the spatial index to %u gears\n", capacity);
+		return false;
+	}
+
+	for (uint32_t g = spatial.capacity; g < capacity; g++)
+	{
+		spatial.cell[g] = NO_CELL;
+		spatial.in_view[g] = 0;
+	}
+	spatial.capacity = capacity;
+	return true;
+}
+
+static void insert_gear(uint32_t gear)
+{
+	const GearLayout *layout = spatial.layout;
+	float center[3] = {layout->x[gear], layout->y[gear], layout->z[gear]};
+	float r = gear_bounding_radius(&spatial.meshes[layout->mesh[gear]]);
+	uint32_t c = cell_of(center[0], center[1]);
+
+	spatial.next[gear] = spatial.cell_first[c];
+	spatial.prev[gear] = -1;
+	if (spatial.cell_first[c] >= 0)
+		spatial.prev[spatial.cell_first[c]] = (int32_t)gear;
+	spatial.cell_first[c] = (int32_t)gear;
+	spatial.cell[gear] = c;
+	spatial.radius[gear] = r;
+
+	float *bounds = spatial.cell_bounds[c];
+	for (int a = 0; a < 3; a++)
+	{
+		bounds[a] = SDL_min(bounds[a], center[a] - r);
+		bounds[3 + a] = SDL_max(bounds[3 + a], center[a] + r);
+	}
+	spatial.max_radius = SDL_max(spatial.max_radius, r);
+}
+
+static void remove_gear(uint32_t gear)
+{
+	int32_t next = spatial.next[gear], prev = spatial.prev[gear];
+
+	if (prev >= 0)
+		spatial.next[prev] = next;
+	else
+		spatial.cell_first[spatial.cell[gear]] = next;
+	if (next >= 0)
+		spatial.prev[next] = prev;
+
+	spatial.cell[gear] = NO_CELL;
+}
+
+bool spatial_build(const GearLayout *layout, const GearParams *meshes)
+{
+	spatial_destroy();
+	spatial.layout = layout;
+	spatial.meshes = meshes;
+
+	/* size the cells from the spread of the gear centers */
+	float min_xy[2] = {0.0f, 0.0f}, max_xy[2] = {0.0f, 0.0f};
+	float max_radius = 0.0f;
+	for (uint32_t g = 0; g < layout->count; g++)
+	{
+		float xy[2] = {layout->x[g], layout->y[g]};
+		for (int a = 0; a < 2; a++)
+		{
+			min_xy[a] = g == 0 ? xy[a] : SDL_min(min_xy[a], xy[a]);
+			max_xy[a] = g == 0 ? xy[a] : SDL_max(max_xy[a], xy[a]);
+		}
+		max_radius = SDL_max(max_radius, gear_bounding_radius(&meshes[layout->mesh[g]]));
+	}
+
+	float width = SDL_max(max_xy[0] - min_xy[0], 1.0f);
+	float height = SDL_max(max_xy[1] - min_xy[1], 1.0f);
+
+	/* no smaller than a gear, so a cell's bounds stay close to its cell */
+	float cell_size = sqrtf(width * height * GEARS_PER_CELL / (float)SDL_max(layout->count, 1u));
+	cell_size = SDL_max(cell_size, 2.0f * max_radius);
+	cell_size = SDL_max(cell_size, SDL_max(width, height) / MAX_GRID_SIZE);
+
+	spatial.origin[0] = min_xy[0];
+	spatial.origin[1] = min_xy[1];
+	spatial.inv_cell_size = 1.0f / cell_size;
+	spatial.columns = SDL_min((uint32_t)(width / cell_size) + 1, MAX_GRID_SIZE);
+	spatial.rows = SDL_min((uint32_t)(height / cell_size) + 1, MAX_GRID_SIZE);
+
+	uint32_t cells = spatial.columns * spatial.rows;
+	spatial.cell_first = (int32_t *)malloc(cells * sizeof(int32_t));
+	spatial.cell_bounds = (float(*)[6])malloc(cells * sizeof(*spatial.cell_bounds));
+	if (!spatial.cell_first || !spatial.cell_bounds || !reserve_gears(SDL_max(layout->count, 1u)))
+	{
+		printf("Failed to allocate spatial index for %u gears\n", layout->count);
+		spatial_destroy();
+		return false;
+	}
+
+	for (uint32_t c = 0; c < cells; c++)
+	{
+		spatial.cell_first[c] = -1;
+		spatial.cell_bounds[c][0] = spatial.cell_bounds[c][1] = spatial.cell_bounds[c][2] = INFINITY;
+		spatial.cell_bounds[c][3] = spatial.cell_bounds[c][4] = spatial.cell_bounds[c][5] = -INFINITY;
+	}
+
+	for (uint32_t g = 0; g < layout->count; g++)
+		insert_gear(g);
+
+#ifdef _DEBUG
+	printf("Spatial index: %ux%u cells of %.1f units for %u gears\n", spatial.columns, spatial.rows, cell_size, layout->count);
+#endif
+
+	return true;
+}
+
+void spatial_destroy(void)
+{
+	free(spatial.cell_first);
+	free(spatial.cell_bounds);
+	free(spatial.next);
+	free(spatial.prev);
+	free(spatial.cell);
+	free(spatial.radius);
+	free(spatial.visible);
+	free(spatial.in_view);
+
+	memset(&spatial, 0, sizeof(spatial));
+}
+
+bool spatial_update_gear(uint32_t gear)
+{
+	if (!spatial.cell_first || gear >= spatial.layout->count || !reserve_gears(gear + 1))
+		return false;
+
+	if (spatial.cell[gear] != NO_CELL)
+		remove_gear(gear);
+	insert_gear(gear);
+	return true;
+}
+
+uint32_t spatial_query_frustum(const float *view_projection, const uint32_t **visible)
+{
+	*visible = spatial.visible;
+	if (!spatial.cell_first)
+		return 0;
+
+	/* the six clip planes (Gribb/Hartmann), normalized so they give distances */
+	const float *m = view_projection;
+	float planes[6][4];
+	for (int p = 0; p < 6; p++)
+	{
+		int row = p / 2;
+		float sign = (p & 1) ? -1.0f : 1.0f;
+		for (int c = 0; c < 4; c++)
+			planes[p][c] = m[c * 4 + 3] + sign * m[c * 4 + row];
+
+		float inv_len = 1.0f / sqrtf(planes[p][0] * planes[p][0] + planes[p][1] * planes[p][1] + planes[p][2] * planes[p][2]);
+		for (int c = 0; c < 4; c++)
+			planes[p][c] *= inv_len;
+	}
+
+	/* the cells hand out gears in no particular order, so they're only marked here and collected in layout order below */
+	const GearLayout *layout = spatial.layout;
+	uint32_t marked = 0;
+	for (uint32_t c = 0; c < spatial.columns * spatial.rows; c++)
+	{
+		if (spatial.cell_first[c] < 0)
+			continue;
+
+		/* the cell is out if its box is entirely behind a plane, and all in if it's entirely in front of every one */
+		const float *bounds = spatial.cell_bounds[c];
+		bool outside = false, inside = true;
+		for (int p = 0; p < 6 && !outside; p++)
+		{
+			float nearest = planes[p][3], farthest = planes[p][3];
+			for (int a = 0; a < 3; a++)
+			{
+				float lo = planes[p][a] * bounds[a], hi = planes[p][a] * bounds[3 + a];
+				nearest += SDL_min(lo, hi);
+				farthest += SDL_max(lo, hi);
+			}
+			outside = farthest < 0.0f;
+			inside = inside && nearest >= 0.0f;
+		}
+		if (outside)
+			continue;
+
+		for (int32_t g = spatial.cell_first[c]; g >= 0; g = spatial.next[g])
+		{
+			bool in = inside;
+			if (!in)
+			{
+				in = true;
+				for (int p = 0; p < 6 && in; p++)
+					in = planes[p][0] * layout->x[g] + planes[p][1] * layout->y[g] + planes[p][2] * layout->z[g] + planes[p][3] >= -spatial.radius[g];
+			}
+			spatial.in_view[g] = in;
+			marked += in;
+		}
+	}
+
+	/* layout order, so runs of one mesh stay together for the instanced draws, clearing the marks for the next query */
+	uint32_t count = 0;
+	for (uint32_t g = 0; count < marked; g++)
+	{
+		if (spatial.in_view[g])
+		{
+			spatial.in_view[g] = 0;
+			spatial.visible[count++] = g;
+		}
+	}
+	return count;
+}
+
+uint32_t spatial_query_point(const float point[3], uint32_t *hits, uint32_t max_hits)
+{
+	if (!spatial.cell_first)
+		return 0;
+
+	/* any sphere holding the point has its center within max_radius, and clamping to the grid keeps those cells in range */
+	float r = spatial.max_radius;
+	uint32_t x0 = cell_coord(point[0] - r, spatial.origin[0], spatial.columns), x1 = cell_coord(point[0] + r, spatial.origin[0], spatial.columns);
+	uint32_t y0 = cell_coord(point[1] - r, spatial.origin[1], spatial.rows), y1 = cell_coord(point[1] + r, spatial.origin[1], spatial.rows);
+
+	const GearLayout *layout = spatial.layout;
+	uint32_t count = 0;
+	for (uint32_t y = y0; y <= y1; y++)
+	{
+		for (uint32_t x = x0; x <= x1; x++)
+		{
+			uint32_t c = y * spatial.columns + x;
+			const float *bounds = spatial.cell_bounds[c];
+			if (point[0] < bounds[0] || point[1] < bounds[1] || point[2] < bounds[2] || point[0] > bounds[3] || point[1] > bounds[4] || point[2] > bounds[5])
+				continue;
+
+			for (int32_t g = spatial.cell_first[c]; g >= 0; g = spatial.next[g])
+			{
+				float dx = point[0] - layout->x[g], dy = point[1] - layout->y[g], dz = point[2] - layout->z[g];
+				if (dx * dx + dy * dy + dz * dz > spatial.radius[g] * spatial.radius[g])
+					continue;
+				if (count < max_hits)
+					hits[count] = (uint32_t)g;
+				count++;
+			}
+		}
+	}
+
+	return count;
+}
+
+/* where the ray enters the box, or INFINITY if it misses it */
+static float ray_box(const float origin[3], const float direction[3], const float *bounds)
+{
+	float t_enter = 0.0f, t_exit = INFINITY;
+	for (int a = 0; a < 3; a++)
+	{
+		if (direction[a] == 0.0f)
+		{
+			if (origin[a] < bounds[a] || origin[a] > bounds[3 + a])
+				return INFINITY;
+			continue;
+		}
+
+		float t0 = (bounds[a] - origin[a]) / direction[a];
+		float t1 = (bounds[3 + a] - origin[a]) / direction[a];
+		t_enter = SDL_max(t_enter, SDL_min(t0, t1));
+		t_exit = SDL_min(t_exit, SDL_max(t0, t1));
+	}
+
+	return t_enter <= t_exit ? t_enter : INFINITY;
+}
+
+bool spatial_query_ray(const float origin[3], const float direction[3], uint32_t *gear, float *t)
+{
+	if (!spatial.cell_first)
+		return false;
+
+	const GearLayout *layout = spatial.layout;
+	float a = direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2];
+	float best = INFINITY;
+	if (a == 0.0f)
+		return false;
+
+	for (uint32_t c = 0; c < spatial.columns * spatial.rows; c++)
+	{
+		/* nothing in a cell the ray enters after the best hit so far can beat it */
+		if (spatial.cell_first[c] < 0 || ray_box(origin, direction, spatial.cell_bounds[c]) >= best)
+			continue;
+
+		for (int32_t g = spatial.cell_first[c]; g >= 0; g = spatial.next[g])
+		{
+			float oc[3] = {origin[0] - layout->x[g], origin[1] - layout->y[g], origin[2] - layout->z[g]};
+			float b = oc[0] * direction[0] + oc[1] * direction[1] + oc[2] * direction[2];
+			float cc = oc[0] * oc[0] + oc[1] * oc[1] + oc[2] * oc[2] - spatial.radius[g] * spatial.radius[g];
+
+			/* |oc + t * direction|^2 = r^2, the nearer root, or 0 if the ray starts inside */
+			float hit;
+			if (cc <= 0.0f)
+				hit = 0.0f;
+			else
+			{
+				float disc = b * b - a * cc;
+				if (disc < 0.0f || b > 0.0f)
+					continue;
+				hit = (-b - sqrtf(disc)) / a;
+			}
+
+			if (hit < best)
+			{
+				best = hit;
+				*gear = (uint32_t)g;
+			}
+		}
+	}
+
+	if (best == INFINITY)
+		return false;
+
+	*t = best;
+	return true;
+}
@@ -0,0 +1,32 @@
+/*
+ * Copyright (C) 2025 William Horvath
+ */
+
+#pragma once
+#include <stdbool.h>
+
+#include <stdint.h>
+
+typedef struct GearLayout GearLayout;
+typedef struct GearParams GearParams;
+
+/* uniform grid over the xy plane (the one gears are laid out in), binning every gear's bounding sphere by its center
+ * each cell keeps the bounds of the spheres binned in it, so gears past the edge of the grid just widen its border cells
+ * the animation only spins gears around their own z axis, which doesn't move their spheres, so nothing changes per frame */
+
+/* index every gear of layout, which must outlive the index (meshes gives each gear's bounding radius) */
+bool spatial_build(const GearLayout *layout, const GearParams *meshes);
+void spatial_destroy(void);
+
+/* re-bin gear after its position in the layout changed, or add it if it was appended to the layout since */
+bool spatial_update_gear(uint32_t gear);
+
+/* gears whose sphere isn't fully outside the frustum of a column-major view-projection matrix, ascending
+ * the list belongs to the index and is valid until its next query or update */
+uint32_t spatial_query_frustum(const float *view_projection, const uint32_t **visible);
+
+/* up to max_hits gears whose sphere contains point, returns how many there are in total */
+uint32_t spatial_query_point(const float point[3], uint32_t *hits, uint32_t max_hits);
+
+/* the first gear whose sphere the ray origin + t * direction (t >= 0) enters, false if there's none */
+bool spatial_query_ray(const float origin[3], const float direction[3], uint32_t *gear, float *t);
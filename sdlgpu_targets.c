@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2025 William Horvath
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <SDL3/SDL_gpu.h>
+
+#include "sdlgpu_frames.h"
+#include "sdlgpu_targets.h"
+#include "sdlgpu_trace.h"
+
+/* enough for a window, its fullscreen size and a couple of buckets of dragging in between */
+#define DEPTH_POOL_SIZE 4
+
+/* buckets are 1/16th of the next power of two wide, so a target is less than 12.5% (or 32 pixels) larger than asked for per dimension */
+#define MIN_BUCKET_STEP 32
+
+typedef struct PooledTarget
+{
+	SDL_GPUTexture *texture;
+	uint32_t width, height; /* bucketed */
+	uint64_t last_used;
+} PooledTarget;
+
+static struct
+{
+	PooledTarget depth[DEPTH_POOL_SIZE];
+	int current; /* the entry handed out last, -1 if none */
+	uint64_t uses;
+	uint64_t hits, misses;
+} targets = {.current = -1};
+
+static uint32_t bucket_size(uint32_t size)
+{
+	uint32_t step = MIN_BUCKET_STEP;
+	while (step * 16 < size)
+		step *= 2;
+	return (size + step - 1) / step * step;
+}
+
+static SDL_GPUTexture *create_depth_target(SDL_GPUDevice *device, uint32_t width, uint32_t height)
+{
+	SDL_GPUTextureCreateInfo depth_info = {.type = SDL_GPU_TEXTURETYPE_2D,
+	                                       .format = SDL_GPU_TEXTUREFORMAT_D32_FLOAT,
+	                                       .usage = SDL_GPU_TEXTUREUSAGE_DEPTH_STENCIL_TARGET,
+	                                       .width = width,
+	                                       .height = height,
+	                                       .layer_count_or_depth = 1,
+	                                       .num_levels = 1,
+	                                       .sample_count = SDL_GPU_SAMPLECOUNT_1,
+	                                       .props = 0};
+
+	trace_begin("create_depth_target");
+	SDL_GPUTexture *texture = SDL_CreateGPUTexture(device, &depth_info);
+	trace_end("create_depth_target");
+	if (!texture)
+		printf("Failed to create %ux%u depth target: %s\n", width, height, SDL_GetError());
+
+	return texture;
+}
+
+SDL_GPUTexture *acquire_depth_target(SDL_GPUDevice *device, uint32_t width, uint32_t height)
+{
+	uint32_t bucket_width = bucket_size(width);
+	uint32_t bucket_height = bucket_size(height);
+
+	/* the common case, same bucket as last frame, isn't a lookup */
+	if (targets.current >= 0 && targets.depth[targets.current].width == bucket_width && targets.depth[targets.current].height == bucket_height)
+		return targets.depth[targets.current].texture;
+
+	targets.uses++;
+
+	int victim = 0;
+	for (int i = 0; i < DEPTH_POOL_SIZE; i++)
+	{
+		PooledTarget *entry = &targets.depth[i];
+		if (entry->texture && entry->width == bucket_width && entry->height == bucket_height)
+		{
+			targets.hits++;
+			entry->last_used = targets.uses;
+			targets.current = i;
+			return entry->texture;
+		}
+
+		/* an empty entry, or else the least recently used one */
+		PooledTarget *best = &targets.depth[victim];
+		if (best->texture && (!entry->texture || entry->last_used < best->last_used))
+			victim = i;
+	}
+
+	targets.misses++;
+
+	SDL_GPUTexture *texture = create_depth_target(device, bucket_width, bucket_height);
+	if (!texture)
+		return NULL;
+
+	/* frames still in flight may be rendering into the evicted one */
+	PooledTarget *entry = &targets.depth[victim];
+	retire_texture(entry->texture);
+	*entry = (PooledTarget){.texture = texture, .width = bucket_width, .height = bucket_height, .last_used = targets.uses};
+	targets.current = victim;
+
+	return texture;
+}
+
+void destroy_render_targets(SDL_GPUDevice *device)
+{
+	for (int i = 0; i < DEPTH_POOL_SIZE; i++)
+	{
+		if (targets.depth[i].texture)
+			SDL_ReleaseGPUTexture(device, targets.depth[i].texture);
+	}
+
+	memset(&targets, 0, sizeof(targets));
+	targets.current = -1;
+}
+
+void render_targets_report(void)
+{
+	uint32_t pooled = 0;
+	for (int i = 0; i < DEPTH_POOL_SIZE; i++)
+		pooled += targets.depth[i].texture ? 1 : 0;
+
+	printf("  depth targets: %llu hits, %llu misses, %u of %u pooled\n", (unsigned long long)targets.hits, (unsigned long long)targets.misses, pooled,
+	       DEPTH_POOL_SIZE);
+}
@@ -0,0 +1,24 @@
+/*
+ * Copyright (C) 2025 William Horvath
+ */
+
+#pragma once
+#include <stdbool.h>
+
+#include <stdint.h>
+
+typedef struct SDL_GPUDevice SDL_GPUDevice;
+typedef struct SDL_GPUTexture SDL_GPUTexture;
+
+/* pool of the few most recently used depth targets, allocated in rounded-up size buckets and drawn into through the viewport,
+ * so resizing a window only allocates when it crosses into a bucket it hasn't used lately, and toggling fullscreen not at all */
+
+/* a depth target at least width x height, NULL on failure
+ * the pool owns it, and it stays valid until a later call for a different size evicts it (frames in flight keep it alive) */
+SDL_GPUTexture *acquire_depth_target(SDL_GPUDevice *device, uint32_t width, uint32_t height);
+
+/* release every pooled target, once nothing in flight uses them anymore */
+void destroy_render_targets(SDL_GPUDevice *device);
+
+/* print how often size changes were served from the pool */
+void render_targets_report(void);
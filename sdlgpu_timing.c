@@ -0,0 +1,304 @@
+/*
+ * Copyright (C) 2025 William Horvath
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <SDL3/SDL_stdinc.h>
+#include <SDL3/SDL_timer.h>
+
+#include "sdlgpu_timing.h"
+
+/* how many of the most recent frames are kept */
+#define TIMING_HISTORY 8192
+
+typedef struct FrameTiming
+{
+	float ms[NUM_FRAME_PHASES]; /* ms[PHASE_FRAME] is < 0 for the very first frame, which has no previous one to measure from */
+	float latency_ms; /* estimated input-to-present latency, < 0 for frames without new input */
+} FrameTiming;
+
+typedef struct PhaseStats
+{
+	double min, mean, p50, p95, p99, max;
+} PhaseStats;
+
+static const char *phase_names[NUM_FRAME_PHASES] = {"acquire", "setup", "record", "submit", "frame"};
+
+static struct
+{
+	FrameTiming history[TIMING_HISTORY]; /* ring buffer */
+	unsigned long long total_frames;     /* frames ever recorded, history[total_frames % TIMING_HISTORY] is the next slot */
+	FrameTiming current;
+	Uint64 frame_start;
+	Uint64 last_mark;
+	Uint64 prev_frame_start;
+	unsigned long long window_start; /* first frame of the current timing_begin_window() */
+	double ticks_to_ms;
+} timing;
+
+static inline double ticks_to_ms(Uint64 ticks)
+{
+	if (timing.ticks_to_ms == 0.0)
+		timing.ticks_to_ms = 1000.0 / (double)SDL_GetPerformanceFrequency();
+	return (double)ticks * timing.ticks_to_ms;
+}
+
+void timing_begin_frame(void)
+{
+	Uint64 now = SDL_GetPerformanceCounter();
+
+	memset(&timing.current, 0, sizeof(timing.current));
+	timing.current.latency_ms = -1.0f;
+	timing.current.ms[PHASE_FRAME] = timing.prev_frame_start ? (float)ticks_to_ms(now - timing.prev_frame_start) : -1.0f;
+
+	timing.prev_frame_start = now;
+	timing.frame_start = now;
+	timing.last_mark = now;
+}
+
+void timing_mark(FramePhase phase)
+{
+	Uint64 now = SDL_GetPerformanceCounter();
+	timing.current.ms[phase] += (float)ticks_to_ms(now - timing.last_mark);
+	timing.last_mark = now;
+}
+
+void timing_input_latency(double input_to_submit_ms, unsigned int frames_queued)
+{
+	/* every frame queued up to and including this one takes about a frame interval to get through the gpu and the presentation engine */
+	timing.current.latency_ms = (float)(input_to_submit_ms + frames_queued * SDL_max(timing.current.ms[PHASE_FRAME], 0.0f));
+}
+
+void timing_end_frame(void)
+{
+	timing.history[timing.total_frames % TIMING_HISTORY] = timing.current;
+	timing.total_frames++;
+}
+
+static unsigned int history_count(void)
+{
+	return timing.total_frames < TIMING_HISTORY ? (unsigned int)timing.total_frames : TIMING_HISTORY;
+}
+
+/* oldest first */
+static const FrameTiming *history_at(unsigned int i)
+{
+	unsigned long long first = timing.total_frames - history_count();
+	return &timing.history[(first + i) % TIMING_HISTORY];
+}
+
+static int compare_float(const void *a, const void *b)
+{
+	float fa = *(const float *)a, fb = *(const float *)b;
+	return (fa > fb) - (fa < fb);
+}
+
+/* nearest-rank percentile of a sorted array */
+static inline double percentile(const float *sorted, unsigned int count, double p)
+{
+	unsigned int rank = (unsigned int)(p / 100.0 * count + 0.5);
+	if (rank < 1)
+		rank = 1;
+	if (rank > count)
+		rank = count;
+	return sorted[rank - 1];
+}
+
+static bool compute_stats(PhaseStats stats[NUM_FRAME_PHASES])
+{
+	unsigned int count = history_count();
+	if (count == 0)
+		return false;
+
+	float *values = (float *)malloc(count * sizeof(float));
+	if (!values)
+		return false;
+
+	for (int phase = 0; phase < NUM_FRAME_PHASES; phase++)
+	{
+		/* skips the invalid first PHASE_FRAME sample */
+		double sum = 0.0;
+		unsigned int valid = 0;
+		for (unsigned int i = 0; i < count; i++)
+		{
+			float ms = history_at(i)->ms[phase];
+			if (ms < 0.0f)
+				continue;
+			values[valid++] = ms;
+			sum += ms;
+		}
+
+		memset(&stats[phase], 0, sizeof(stats[phase]));
+		if (valid == 0)
+			continue;
+
+		qsort(values, valid, sizeof(float), compare_float);
+
+		stats[phase].min = values[0];
+		stats[phase].mean = sum / valid;
+		stats[phase].p50 = percentile(values, valid, 50.0);
+		stats[phase].p95 = percentile(values, valid, 95.0);
+		stats[phase].p99 = percentile(values, valid, 99.0);
+		stats[phase].max = values[valid - 1];
+	}
+
+	free(values);
+	return true;
+}
+
+void timing_report(void)
+{
+	PhaseStats stats[NUM_FRAME_PHASES];
+	if (!compute_stats(stats))
+		return;
+
+	printf("  %-17s %8s %8s %8s %8s %8s %8s   (last %u frames)\n", "phase (ms)", "min", "mean", "p50", "p95", "p99", "max", history_count());
+	for (int phase = 0; phase < NUM_FRAME_PHASES; phase++)
+	{
+		printf("  %-17s %8.3f %8.3f %8.3f %8.3f %8.3f %8.3f\n", phase_names[phase], stats[phase].min, stats[phase].mean, stats[phase].p50, stats[phase].p95,
+		       stats[phase].p99, stats[phase].max);
+	}
+	fflush(stdout);
+}
+
+void timing_begin_window(void)
+{
+	timing.window_start = timing.total_frames;
+}
+
+unsigned int timing_window_frames(void)
+{
+	unsigned int count = history_count();
+	if (timing.total_frames - timing.window_start < count)
+		count = (unsigned int)(timing.total_frames - timing.window_start);
+	return count;
+}
+
+bool timing_window_stats(WindowStats *stats)
+{
+	unsigned int count = timing_window_frames();
+
+	memset(stats, 0, sizeof(*stats));
+	if (count == 0)
+		return false;
+
+	float *values = (float *)malloc(3 * count * sizeof(float));
+	if (!values)
+		return false;
+
+	float *acquire = values, *frame = values + count, *latency = values + 2 * count;
+	unsigned int frame_count = 0, latency_count = 0;
+	double frame_squares = 0.0;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		const FrameTiming *timings = history_at(history_count() - count + i);
+		acquire[i] = timings->ms[PHASE_ACQUIRE];
+		stats->acquire_mean += acquire[i];
+		if (timings->ms[PHASE_FRAME] >= 0.0f)
+		{
+			frame[frame_count++] = timings->ms[PHASE_FRAME];
+			stats->frame_mean += timings->ms[PHASE_FRAME];
+			frame_squares += (double)timings->ms[PHASE_FRAME] * timings->ms[PHASE_FRAME];
+		}
+		if (timings->latency_ms >= 0.0f)
+		{
+			latency[latency_count++] = timings->latency_ms;
+			stats->latency_mean += timings->latency_ms;
+		}
+	}
+
+	qsort(acquire, count, sizeof(float), compare_float);
+	qsort(frame, frame_count, sizeof(float), compare_float);
+	qsort(latency, latency_count, sizeof(float), compare_float);
+
+	stats->frames = count;
+	stats->acquire_mean /= count;
+	stats->acquire_p95 = percentile(acquire, count, 95.0);
+	if (frame_count)
+	{
+		stats->frame_mean /= frame_count;
+		stats->frame_stddev = sqrt(SDL_max(frame_squares / frame_count - stats->frame_mean * stats->frame_mean, 0.0));
+		stats->frame_p95 = percentile(frame, frame_count, 95.0);
+	}
+	stats->latency_samples = latency_count;
+	if (latency_count)
+	{
+		stats->latency_mean /= latency_count;
+		stats->latency_p95 = percentile(latency, latency_count, 95.0);
+	}
+
+	free(values);
+	return true;
+}
+
+bool timing_export(const char *path)
+{
+	FILE *f = fopen(path, "w");
+	if (!f)
+	{
+		printf("Failed to open %s for writing timing data\n", path);
+		return false;
+	}
+
+	unsigned int count = history_count();
+	unsigned long long first = timing.total_frames - count;
+	size_t len = strlen(path);
+	bool json = len >= 5 && strcmp(path + len - 5, ".json") == 0;
+
+	if (json)
+	{
+		PhaseStats stats[NUM_FRAME_PHASES];
+		bool have_stats = compute_stats(stats);
+
+		fprintf(f, "{\n  \"summary\": {");
+		for (int phase = 0; have_stats && phase < NUM_FRAME_PHASES; phase++)
+		{
+			fprintf(f, "%s\n    \"%s\": {\"min\": %.4f, \"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f}", phase ? "," : "",
+			        phase_names[phase], stats[phase].min, stats[phase].mean, stats[phase].p50, stats[phase].p95, stats[phase].p99, stats[phase].max);
+		}
+		fprintf(f, "\n  },\n  \"frames\": [");
+		for (unsigned int i = 0; i < count; i++)
+		{
+			const FrameTiming *frame = history_at(i);
+			fprintf(f, "%s\n    {\"frame\": %llu", i ? "," : "", first + i);
+			for (int phase = 0; phase < NUM_FRAME_PHASES; phase++)
+			{
+				if (frame->ms[phase] < 0.0f)
+					fprintf(f, ", \"%s\": null", phase_names[phase]);
+				else
+					fprintf(f, ", \"%s\": %.4f", phase_names[phase], frame->ms[phase]);
+			}
+			fprintf(f, "}");
+		}
+		fprintf(f, "\n  ]\n}\n");
+	}
+	else
+	{
+		fprintf(f, "frame");
+		for (int phase = 0; phase < NUM_FRAME_PHASES; phase++)
+			fprintf(f, ",%s_ms", phase_names[phase]);
+		fprintf(f, "\n");
+
+		for (unsigned int i = 0; i < count; i++)
+		{
+			const FrameTiming *frame = history_at(i);
+			fprintf(f, "%llu", first + i);
+			for (int phase = 0; phase < NUM_FRAME_PHASES; phase++)
+			{
+				if (frame->ms[phase] < 0.0f)
+					fprintf(f, ",");
+				else
+					fprintf(f, ",%.4f", frame->ms[phase]);
+			}
+			fprintf(f, "\n");
+		}
+	}
+
+	fclose(f);
+	printf("Wrote timing data for %u frames to %s\n", count, path);
+	return true;
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2025 William Horvath
+ */
+
+#pragma once
+#include <stdbool.h>
+
+/* phases of draw_frame() that get timed separately */
+typedef enum FramePhase
+{
+	PHASE_ACQUIRE, /* command buffer + swapchain wait (or fence wait when headless, plus the hand-off with -render_thread) + depth texture */
+	PHASE_SETUP,   /* matrices and uniform/instance data */
+	PHASE_RECORD,  /* render pass recording */
+	PHASE_SUBMIT,  /* command buffer submission */
+	PHASE_FRAME,   /* start-to-start interval, including everything outside of draw_frame(), none for the first frame */
+	NUM_FRAME_PHASES
+} FramePhase;
+
+/* per-frame recording, only frames that reach timing_end_frame() are kept */
+void timing_begin_frame(void);
+void timing_mark(FramePhase phase); /* attributes the time since the previous mark to phase */
+void timing_end_frame(void);
+
+/* attributes an input-to-present latency estimate to the current frame: the time from the input to submitting the frame that shows it,
+ * plus a frame interval for each of the frames_queued frames the gpu still had to finish (this one included) */
+void timing_input_latency(double input_to_submit_ms, unsigned int frames_queued);
+
+/* print min/mean/p50/p95/p99/max of each phase over the frames currently in the history */
+void timing_report(void);
+
+/* write the frame history to path, as JSON (with a summary) if it ends in ".json", otherwise as CSV */
+bool timing_export(const char *path);
+
+/* the frames since the last timing_begin_window() (as far as the history goes back), to compare configurations within a run */
+typedef struct WindowStats
+{
+	unsigned int frames;
+	double acquire_mean, acquire_p95; /* PHASE_ACQUIRE, mostly the wait for a swapchain image */
+	double frame_mean, frame_p95;     /* PHASE_FRAME */
+	double frame_stddev;
+	unsigned int latency_samples;     /* frames that had new input */
+	double latency_mean, latency_p95;
+} WindowStats;
+
+void timing_begin_window(void);
+/* how many frames timing_window_stats() would cover, without computing anything */
+unsigned int timing_window_frames(void);
+/* false if the window has no frames yet */
+bool timing_window_stats(WindowStats *stats);
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2025 William Horvath
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <SDL3/SDL_atomic.h>
+#include <SDL3/SDL_thread.h>
+#include <SDL3/SDL_timer.h>
+
+#include "sdlgpu_trace.h"
+
+typedef struct TraceEvent
+{
+	const char *name;
+	Uint64 ticks;
+	SDL_ThreadID thread;
+	char phase;
+} TraceEvent;
+
+bool trace_active = false;
+
+static struct
+{
+	TraceEvent *events;
+	unsigned int capacity;
+	SDL_AtomicInt count; /* may run past capacity, anything beyond it is dropped */
+	const char *path;
+	Uint64 start;
+} trace;
+
+bool trace_init(const char *path, unsigned int max_events)
+{
+	trace.events = (TraceEvent *)malloc((size_t)max_events * sizeof(TraceEvent));
+	if (!trace.events)
+	{
+		printf("Failed to allocate trace buffer for %u events\n", max_events);
+		return false;
+	}
+
+	trace.capacity = max_events;
+	SDL_SetAtomicInt(&trace.count, 0);
+	trace.path = path;
+	trace.start = SDL_GetTicksNS();
+	trace_active = true;
+	return true;
+}
+
+void trace_event(const char *name, char phase)
+{
+	unsigned int slot = (unsigned int)SDL_AddAtomicInt(&trace.count, 1);
+	if (slot >= trace.capacity)
+		return;
+
+	TraceEvent *event = &trace.events[slot];
+	event->name = name;
+	event->ticks = SDL_GetTicksNS();
+	event->thread = SDL_GetCurrentThreadID();
+	event->phase = phase;
+}
+
+void trace_shutdown(void)
+{
+	if (!trace.events)
+		return;
+
+	trace_active = false;
+
+	unsigned int recorded = (unsigned int)SDL_GetAtomicInt(&trace.count);
+	unsigned int count = recorded < trace.capacity ? recorded : trace.capacity;
+
+	FILE *f = fopen(trace.path, "w");
+	if (f)
+	{
+		fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+		for (unsigned int i = 0; i < count; i++)
+		{
+			const TraceEvent *event = &trace.events[i];
+			fprintf(f, "%s\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%llu}", i ? "," : "", event->name, event->phase,
+			        (double)(event->ticks - trace.start) / 1000.0, (unsigned long long)event->thread);
+		}
+		fprintf(f, "\n]}\n");
+		fclose(f);
+
+		printf("Wrote %u trace events to %s", count, trace.path);
+		if (recorded > count)
+			printf(" (%u dropped, buffer full)", recorded - count);
+		printf("\n");
+	}
+	else
+	{
+		printf("Failed to open %s for writing the trace\n", trace.path);
+	}
+
+	free(trace.events);
+	trace.events = NULL;
+}
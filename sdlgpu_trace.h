@@ -0,0 +1,31 @@
+/*
+ * Copyright (C) 2025 William Horvath
+ */
+
+#pragma once
+#include <stdbool.h>
+
+/* Chrome trace-event (chrome://tracing, ui.perfetto.dev) recording of nested zones
+ * events are only buffered in memory while running, and written out by trace_shutdown() */
+
+/* start recording, keeping up to max_events events */
+bool trace_init(const char *path, unsigned int max_events);
+/* write the trace file and free the buffer */
+void trace_shutdown(void);
+
+/* internal, use trace_begin/trace_end */
+extern bool trace_active;
+void trace_event(const char *name, char phase);
+
+/* zones must be properly nested per thread, name must be a string literal (or otherwise outlive the trace) */
+static inline void trace_begin(const char *name)
+{
+	if (trace_active)
+		trace_event(name, 'B');
+}
+
+static inline void trace_end(const char *name)
+{
+	if (trace_active)
+		trace_event(name, 'E');
+}
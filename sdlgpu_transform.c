@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2025 William Horvath
+ */
+
+#include "sdlgpu_transform.h"
+#include "sdlgpu_math.h"
+#include "sdlgpu_render.h"
+
+#if defined(MATH_SSE) && (defined(__SSE2__) || defined(_M_X64))
+#define TRANSFORM_SSE2 1
+#include <emmintrin.h>
+#endif
+
+/* every gear's model matrix is translate(x, y, z) * rotate_z(theta), so with PV = projection * view:
+ *   mvp    = (c * PV0 + s * PV1,  c * PV1 - s * PV0,  PV2,  x * PV0 + y * PV1 + z * PV2 + PV3)
+ *   normal = (c * V0 + s * V1,    c * V1 - s * V0,    V2)
+ * which is all the per-gear work there is, besides the sine and cosine */
+
+/* sine and cosine of 4 angles in degrees
+ * reduced to +-45 degrees by quadrant first, then minimax polynomials good to about 1 ulp */
+static inline void sincos_deg4(const float *deg, float *s, float *c)
+{
+#if defined(TRANSFORM_SSE2)
+	__m128 d = _mm_loadu_ps(deg);
+	__m128i q = _mm_cvtps_epi32(_mm_mul_ps(d, _mm_set1_ps(1.0f / 90.0f))); /* round to nearest quadrant */
+	__m128 r = _mm_mul_ps(_mm_sub_ps(d, _mm_mul_ps(_mm_cvtepi32_ps(q), _mm_set1_ps(90.0f))), _mm_set1_ps((float)(PI / 180.0)));
+	__m128 r2 = _mm_mul_ps(r, r);
+
+	__m128 sp = _mm_add_ps(_mm_mul_ps(r2, _mm_set1_ps(-1.9515295891e-4f)), _mm_set1_ps(8.3321608736e-3f));
+	sp = _mm_add_ps(_mm_mul_ps(sp, r2), _mm_set1_ps(-1.6666654611e-1f));
+	sp = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(sp, r2), r), r);
+
+	__m128 cp = _mm_add_ps(_mm_mul_ps(r2, _mm_set1_ps(2.443315711809948e-5f)), _mm_set1_ps(-1.388731625493765e-3f));
+	cp = _mm_add_ps(_mm_mul_ps(cp, r2), _mm_set1_ps(4.166664568298827e-2f));
+	cp = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(_mm_mul_ps(cp, r2), r2), _mm_mul_ps(r2, _mm_set1_ps(0.5f))), _mm_set1_ps(1.0f));
+
+	/* odd quadrants swap sine and cosine, then the sign comes from bit 1 of q (sine) or q + 1 (cosine) */
+	__m128i one = _mm_set1_epi32(1), two = _mm_set1_epi32(2);
+	__m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(q, one), one));
+	__m128 sin_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(q, two), 30));
+	__m128 cos_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(q, one), two), 30));
+
+	__m128 sv = _mm_or_ps(_mm_and_ps(swap, cp), _mm_andnot_ps(swap, sp));
+	__m128 cv = _mm_or_ps(_mm_and_ps(swap, sp), _mm_andnot_ps(swap, cp));
+	_mm_storeu_ps(s, _mm_xor_ps(sv, sin_sign));
+	_mm_storeu_ps(c, _mm_xor_ps(cv, cos_sign));
+#else
+	for (int i = 0; i < 4; i++)
+	{
+		float rad = (float)(deg[i] * PI / 180.0);
+		s[i] = sinf(rad);
+		c[i] = cosf(rad);
+	}
+#endif
+}
+
+void transform_gears(const GearLayout *layout, uint32_t first, uint32_t count, float angle, const float *view, const float *projection, InstanceData *out)
+{
+	float pv[16];
+	matrix_multiply(pv, projection, view);
+
+	const float *ratio = layout->ratio + first;
+	const float *phase = layout->phase + first;
+	const float *x = layout->x + first;
+	const float *y = layout->y + first;
+	const float *z = layout->z + first;
+	const float(*color)[4] = (const float(*)[4])(layout->color + first);
+
+#if defined(MATH_SSE)
+	__m128 pv0 = _mm_loadu_ps(&pv[0]), pv1 = _mm_loadu_ps(&pv[4]), pv2 = _mm_loadu_ps(&pv[8]), pv3 = _mm_loadu_ps(&pv[12]);
+	__m128 v0 = _mm_loadu_ps(&view[0]), v1 = _mm_loadu_ps(&view[4]), v2 = _mm_loadu_ps(&view[8]);
+#elif defined(MATH_NEON)
+	float32x4_t pv0 = vld1q_f32(&pv[0]), pv1 = vld1q_f32(&pv[4]), pv2 = vld1q_f32(&pv[8]), pv3 = vld1q_f32(&pv[12]);
+	float32x4_t v0 = vld1q_f32(&view[0]), v1 = vld1q_f32(&view[4]), v2 = vld1q_f32(&view[8]);
+#endif
+
+	for (uint32_t base = 0; base < count; base += 4)
+	{
+		uint32_t n = count - base < 4 ? count - base : 4;
+
+		float deg[4] = {0.0f, 0.0f, 0.0f, 0.0f}, s[4], c[4];
+		for (uint32_t i = 0; i < n; i++)
+			deg[i] = ratio[base + i] * angle + phase[base + i];
+		sincos_deg4(deg, s, c);
+
+		for (uint32_t i = 0; i < n; i++)
+		{
+			uint32_t g = base + i;
+			InstanceData *inst = &out[g];
+#if defined(MATH_SSE)
+			__m128 vs = _mm_set1_ps(s[i]), vc = _mm_set1_ps(c[i]);
+			__m128 mvp3 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(pv0, _mm_set1_ps(x[g])), _mm_mul_ps(pv1, _mm_set1_ps(y[g]))),
+			                         _mm_add_ps(_mm_mul_ps(pv2, _mm_set1_ps(z[g])), pv3));
+
+			_mm_storeu_ps(&inst->mvp_matrix[0], _mm_add_ps(_mm_mul_ps(pv0, vc), _mm_mul_ps(pv1, vs)));
+			_mm_storeu_ps(&inst->mvp_matrix[4], _mm_sub_ps(_mm_mul_ps(pv1, vc), _mm_mul_ps(pv0, vs)));
+			_mm_storeu_ps(&inst->mvp_matrix[8], pv2);
+			_mm_storeu_ps(&inst->mvp_matrix[12], mvp3);
+			_mm_storeu_ps(&inst->normal_matrix[0], _mm_add_ps(_mm_mul_ps(v0, vc), _mm_mul_ps(v1, vs)));
+			_mm_storeu_ps(&inst->normal_matrix[4], _mm_sub_ps(_mm_mul_ps(v1, vc), _mm_mul_ps(v0, vs)));
+			_mm_storeu_ps(&inst->normal_matrix[8], v2);
+			_mm_storeu_ps(inst->color, _mm_loadu_ps(color[g]));
+#elif defined(MATH_NEON)
+			float32x4_t mvp3 = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(pv3, pv0, x[g]), pv1, y[g]), pv2, z[g]);
+
+			vst1q_f32(&inst->mvp_matrix[0], vmlaq_n_f32(vmulq_n_f32(pv0, c[i]), pv1, s[i]));
+			vst1q_f32(&inst->mvp_matrix[4], vmlsq_n_f32(vmulq_n_f32(pv1, c[i]), pv0, s[i]));
+			vst1q_f32(&inst->mvp_matrix[8], pv2);
+			vst1q_f32(&inst->mvp_matrix[12], mvp3);
+			vst1q_f32(&inst->normal_matrix[0], vmlaq_n_f32(vmulq_n_f32(v0, c[i]), v1, s[i]));
+			vst1q_f32(&inst->normal_matrix[4], vmlsq_n_f32(vmulq_n_f32(v1, c[i]), v0, s[i]));
+			vst1q_f32(&inst->normal_matrix[8], v2);
+			vst1q_f32(inst->color, vld1q_f32(color[g]));
+#else
+			for (int row = 0; row < 4; row++)
+			{
+				inst->mvp_matrix[0 + row] = c[i] * pv[0 + row] + s[i] * pv[4 + row];
+				inst->mvp_matrix[4 + row] = c[i] * pv[4 + row] - s[i] * pv[0 + row];
+				inst->mvp_matrix[8 + row] = pv[8 + row];
+				inst->mvp_matrix[12 + row] = x[g] * pv[0 + row] + y[g] * pv[4 + row] + z[g] * pv[8 + row] + pv[12 + row];
+				inst->normal_matrix[0 + row] = c[i] * view[0 + row] + s[i] * view[4 + row];
+				inst->normal_matrix[4 + row] = c[i] * view[4 + row] - s[i] * view[0 + row];
+				inst->normal_matrix[8 + row] = view[8 + row];
+				inst->color[row] = color[g][row];
+			}
+#endif
+		}
+	}
+}
@@ -0,0 +1,13 @@
+/*
+ * Copyright (C) 2025 William Horvath
+ */
+
+#pragma once
+#include <stdint.h>
+
+typedef struct GearLayout GearLayout;
+typedef struct InstanceData InstanceData;
+
+/* batched transform pass: writes the mvp matrix, normal matrix and color of gears [first, first + count) to out[0..count)
+ * view must be a rigid transform (no scale, last row 0 0 0 1), which lets the normal matrix be taken from it directly */
+void transform_gears(const GearLayout *layout, uint32_t first, uint32_t count, float angle, const float *view, const float *projection, InstanceData *out);
@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2025 William Horvath
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <SDL3/SDL_gpu.h>
+#include <SDL3/SDL_stdinc.h>
+
+#include "sdlgpu_init.h"
+#include "sdlgpu_timing.h"
+#include "sdlgpu_tuner.h"
+
+/* frames each configuration runs before being measured, to let the swapchain and the frame ring fill up */
+#define TUNE_WARMUP_FRAMES 60
+/* frames each configuration is measured for */
+#define TUNE_MEASURE_FRAMES 300
+
+#define MAX_CANDIDATES (3 * MAX_FRAMES_IN_FLIGHT)
+
+typedef struct Candidate
+{
+	PresentMode present_mode;
+	unsigned int frames_in_flight;
+	WindowStats stats;
+} Candidate;
+
+static struct
+{
+	bool active;
+	TuneObjective objective;
+	char path[256];
+	Candidate candidates[MAX_CANDIDATES];
+	unsigned int num_candidates;
+	unsigned int current;
+	unsigned int frames; /* into the current candidate, warmup included */
+} tuner;
+
+static const char *objective_names[] = {"latency", "throughput", "smoothness"};
+
+/* lower is better */
+static double score(const Candidate *candidate)
+{
+	switch (tuner.objective)
+	{
+	case TUNE_LATENCY:
+		return candidate->stats.latency_samples ? candidate->stats.latency_mean : HUGE_VAL;
+	case TUNE_THROUGHPUT:
+		return candidate->stats.frame_mean;
+	case TUNE_SMOOTHNESS:
+		return candidate->stats.frame_stddev;
+	}
+	return 0.0;
+}
+
+static bool apply_candidate(SDL_Window *window, ViewInput *input, const Candidate *candidate)
+{
+	input->present_mode = set_present_mode(window, input->present_mode, candidate->present_mode);
+	input->frames_in_flight = set_frames_in_flight(window, input->frames_in_flight, candidate->frames_in_flight);
+	return input->present_mode == candidate->present_mode && input->frames_in_flight == candidate->frames_in_flight;
+}
+
+static bool save(const Candidate *best)
+{
+	FILE *f = fopen(tuner.path, "w");
+	if (!f)
+	{
+		printf("Failed to open %s for writing the present configuration\n", tuner.path);
+		return false;
+	}
+
+	fprintf(f, "# tuned for %s\n", objective_names[tuner.objective]);
+	fprintf(f, "present_mode %s\n", present_mode_name(best->present_mode));
+	fprintf(f, "image_count %u\n", best->frames_in_flight);
+	fclose(f);
+
+	printf("Wrote the present configuration to %s\n", tuner.path);
+	return true;
+}
+
+static void finish(SDL_Window *window, ViewInput *input)
+{
+	tuner.active = false;
+
+	printf("Present configurations (%u frames each):\n", TUNE_MEASURE_FRAMES);
+	printf("  %-10s %9s %10s %10s %10s %12s %12s\n", "mode", "in flight", "fps", "stddev", "acquire", "latency", "p95 latency");
+
+	const Candidate *best = NULL;
+	for (unsigned int i = 0; i < tuner.num_candidates; i++)
+	{
+		const Candidate *candidate = &tuner.candidates[i];
+		if (candidate->stats.frames == 0)
+			continue; /* couldn't be applied */
+
+		printf("  %-10s %9u %10.1f %10.3f %10.3f %12.3f %12.3f\n", present_mode_name(candidate->present_mode), candidate->frames_in_flight,
+		       1000.0 / SDL_max(candidate->stats.frame_mean, 1e-6), candidate->stats.frame_stddev, candidate->stats.acquire_mean,
+		       candidate->stats.latency_mean, candidate->stats.latency_p95);
+
+		if (!best || score(candidate) < score(best))
+			best = candidate;
+	}
+
+	if (!best)
+	{
+		printf("Tuning failed, no present configuration could be measured\n");
+		return;
+	}
+
+	printf("Best for %s: %s, %u frames in flight\n", objective_names[tuner.objective], present_mode_name(best->present_mode), best->frames_in_flight);
+	fflush(stdout);
+
+	if (apply_candidate(window, input, best))
+		save(best);
+}
+
+/* apply the next candidate that the window accepts, or finish */
+static void next_candidate(SDL_Window *window, ViewInput *input)
+{
+	for (; tuner.current < tuner.num_candidates; tuner.current++)
+	{
+		if (apply_candidate(window, input, &tuner.candidates[tuner.current]))
+		{
+			tuner.frames = 0;
+			return;
+		}
+	}
+
+	finish(window, input);
+}
+
+bool tuner_start(SDL_Window *window, ViewInput *input, TuneObjective objective, const char *path)
+{
+	memset(&tuner, 0, sizeof(tuner));
+	tuner.objective = objective;
+	SDL_strlcpy(tuner.path, path, sizeof(tuner.path));
+
+	for (int mode = VSYNC; mode <= MAILBOX; mode++)
+	{
+		if (!SDL_WindowSupportsGPUPresentMode(render_state.device, window, (SDL_GPUPresentMode)mode))
+			continue;
+
+		for (unsigned int frames_in_flight = 1; frames_in_flight <= MAX_FRAMES_IN_FLIGHT; frames_in_flight++)
+			tuner.candidates[tuner.num_candidates++] = (Candidate){.present_mode = (PresentMode)mode, .frames_in_flight = frames_in_flight};
+	}
+
+	if (tuner.num_candidates == 0)
+	{
+		printf("Nothing to tune, the window supports no present modes\n");
+		return false;
+	}
+
+	printf("Tuning the present configuration for %s, %u configurations\n", objective_names[objective], tuner.num_candidates);
+	fflush(stdout);
+
+	tuner.active = true;
+	next_candidate(window, input);
+	return tuner.active;
+}
+
+bool tuner_active(void)
+{
+	return tuner.active;
+}
+
+void tuner_frame(SDL_Window *window, ViewInput *input)
+{
+	if (!tuner.active)
+		return;
+
+	tuner.frames++;
+	if (tuner.frames == TUNE_WARMUP_FRAMES)
+		timing_begin_window();
+	if (tuner.frames < TUNE_WARMUP_FRAMES + TUNE_MEASURE_FRAMES)
+		return;
+
+	timing_window_stats(&tuner.candidates[tuner.current].stats);
+	tuner.current++;
+	next_candidate(window, input);
+}
+
+bool tuner_load(const char *path, PresentMode *present_mode, unsigned int *image_count)
+{
+	FILE *f = fopen(path, "r");
+	if (!f)
+		return false;
+
+	char line[256];
+	while (fgets(line, sizeof(line), f))
+	{
+		char key[64], value[64];
+		if (line[0] == '#' || sscanf(line, "%63s %63s", key, value) != 2)
+			continue;
+
+		if (present_mode && strcmp(key, "present_mode") == 0)
+		{
+			for (int mode = VSYNC; mode <= MAILBOX; mode++)
+			{
+				if (SDL_strcasecmp(value, present_mode_name((PresentMode)mode)) == 0)
+					*present_mode = (PresentMode)mode;
+			}
+		}
+		else if (image_count && strcmp(key, "image_count") == 0)
+		{
+			*image_count = SDL_clamp((unsigned int)strtoul(value, NULL, 0), 1u, MAX_FRAMES_IN_FLIGHT);
+		}
+	}
+
+	fclose(f);
+	return true;
+}
@@ -0,0 +1,32 @@
+/*
+ * Copyright (C) 2025 William Horvath
+ */
+
+#pragma once
+#include <stdbool.h>
+
+#include "sdlgpu_render.h"
+#include "sdlgpu_render_thread.h"
+
+typedef struct SDL_Window SDL_Window;
+
+/* what -tune optimizes for */
+typedef enum TuneObjective
+{
+	TUNE_LATENCY,    /* lowest estimated input-to-present latency */
+	TUNE_THROUGHPUT, /* highest frame rate */
+	TUNE_SMOOTHNESS  /* lowest frame time standard deviation */
+} TuneObjective;
+
+/* present configuration calibration: every supported present mode x 1-3 frames in flight is run for a fixed number of frames,
+ * then the best one for the objective is switched to and saved to path, for tuner_load() to pick up on later runs
+ * frames are driven by the caller as usual, so the scene must not be paused, and each configuration is switched to through input
+ * like the P and F keys do, so both this and draw_frame() have to run on the thread that created the window */
+bool tuner_start(SDL_Window *window, ViewInput *input, TuneObjective objective, const char *path);
+/* the P and F keys are ignored while this is true */
+bool tuner_active(void);
+/* after each submitted frame */
+void tuner_frame(SDL_Window *window, ViewInput *input);
+
+/* read a saved configuration, each of present_mode and image_count may be NULL to leave it out, false if there's no file */
+bool tuner_load(const char *path, PresentMode *present_mode, unsigned int *image_count);
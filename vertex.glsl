@@ -1,31 +1,62 @@
 #version 450
 
+#ifdef COMPACT_VERTEX
+// CompactVertex in sdlgpu_render.h: HALF4 position (w = 1) + SHORT2_NORM octahedral normal
+layout(location = 0) in vec4 in_position;
+layout(location = 1) in vec2 in_normal_oct;
+
+vec3 oct_decode(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0)
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    return n; // normalized after the normal matrix anyway
+}
+#else
 layout(location = 0) in vec3 in_position;
 layout(location = 1) in vec3 in_normal;
+#endif
 
-layout(set = 1, binding = 0) uniform UniformBuffer {
-    mat4 mvp_matrix;
-    mat4 model_matrix;
-    mat3 normal_matrix;
+// FrameUniforms in sdlgpu_render.c, pushed once per frame
+layout(set = 1, binding = 0) uniform FrameUniforms {
+    mat4 view_projection;
+    mat4 view; // rigid, so its upper 3x3 also takes normals to view space
     vec3 light_position;
     vec3 light_color;
+} frame;
+
+// DrawUniforms in sdlgpu_render.c, pushed per gear: the model matrix is a rotation around z plus a translation
+layout(set = 1, binding = 1) uniform DrawUniforms {
+    vec3 translation;
+    vec2 rotation; // cos, sin
     vec3 object_color;
-} ubo;
+} draw;
+
+vec3 rotate_z(vec3 v) {
+    return vec3(draw.rotation.x * v.x - draw.rotation.y * v.y, draw.rotation.y * v.x + draw.rotation.x * v.y, v.z);
+}
 
 layout(location = 0) out vec3 frag_color;
 
 void main() {
-    gl_Position = ubo.mvp_matrix * vec4(in_position, 1.0);
+#ifdef COMPACT_VERTEX
+    vec3 position = in_position.xyz;
+    vec3 normal = oct_decode(in_normal_oct);
+#else
+    vec3 position = in_position;
+    vec3 normal = in_normal;
+#endif
+
+    gl_Position = frame.view_projection * vec4(rotate_z(position) + draw.translation, 1.0);
 
     // transform normal to view space for lighting calculation
-    vec3 view_normal = normalize(ubo.normal_matrix * in_normal);
+    vec3 view_normal = normalize(mat3(frame.view) * rotate_z(normal));
 
     // light direction in view space (i.e. glLightfv(GL_LIGHT0, GL_POSITION, pos))
-    vec3 light_dir = normalize(ubo.light_position);
+    vec3 light_dir = normalize(frame.light_position);
 
     float diff = max(dot(view_normal, light_dir), 0.0);
-    vec3 ambient = 0.2 * ubo.object_color;
-    vec3 diffuse = diff * ubo.light_color * ubo.object_color;
+    vec3 ambient = 0.2 * draw.object_color;
+    vec3 diffuse = diff * frame.light_color * draw.object_color;
 
     frag_color = ambient + diffuse;
 }
@@ -1,6 +1,12 @@
 struct VertexInput {
+#ifdef COMPACT_VERTEX
+    // CompactVertex in sdlgpu_render.h: HALF4 position (w = 1) + SHORT2_NORM octahedral normal
+    float4 position : TEXCOORD0;
+    float2 normal_oct : TEXCOORD1;
+#else
     float3 position : TEXCOORD0;
     float3 normal : TEXCOORD1;
+#endif
 };
 
 struct VertexOutput {
@@ -8,32 +14,49 @@ struct VertexOutput {
     float4 position : SV_POSITION;
 };
 
-cbuffer UniformBuffer : register(b0, space1) {
-    float4x4 mvp_matrix;
-    float4x4 model_matrix;
-    // normal_matrix is laid out as 3 vec4s in std140 (each column padded to 16 bytes)
-    float4 normal_matrix_col0;
-    float4 normal_matrix_col1;
-    float4 normal_matrix_col2;
+// FrameUniforms in sdlgpu_render.c, pushed once per frame
+cbuffer FrameUniforms : register(b0, space1) {
+    float4x4 view_projection;
+    float4x4 view;          // rigid, so its upper 3x3 also takes normals to view space
     float4 light_position;  // vec3 padded to vec4
     float4 light_color;     // vec3 padded to vec4
+};
+
+// DrawUniforms in sdlgpu_render.c, pushed per gear: the model matrix is a rotation around z plus a translation
+cbuffer DrawUniforms : register(b1, space1) {
+    float4 translation;     // vec3 padded to vec4
+    float4 rotation;        // cos, sin, padding
     float4 object_color;    // vec3 padded to vec4
 };
 
+float3 rotate_z(float3 v) {
+    return float3(rotation.x * v.x - rotation.y * v.y, rotation.y * v.x + rotation.x * v.y, v.z);
+}
+
+#ifdef COMPACT_VERTEX
+float3 oct_decode(float2 e) {
+    float3 n = float3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0)
+        n.xy = (1.0 - abs(n.yx)) * float2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    return n; // normalized after the normal matrix anyway
+}
+#endif
+
 VertexOutput main(VertexInput input) {
     VertexOutput output;
 
-    output.position = mul(mvp_matrix, float4(input.position, 1.0));
+#ifdef COMPACT_VERTEX
+    float3 position = input.position.xyz;
+    float3 normal = oct_decode(input.normal_oct);
+#else
+    float3 position = input.position;
+    float3 normal = input.normal;
+#endif
 
-    // reconstruct 3x3 normal matrix from the three column vectors
-    float3x3 normal_matrix = float3x3(
-        normal_matrix_col0.xyz,
-        normal_matrix_col1.xyz,
-        normal_matrix_col2.xyz
-    );
+    output.position = mul(view_projection, float4(rotate_z(position) + translation.xyz, 1.0));
 
     // transform normal to view space for lighting calculation
-    float3 view_normal = normalize(mul(input.normal, normal_matrix));
+    float3 view_normal = normalize(mul((float3x3)view, rotate_z(normal)));
 
     // light direction in view space (i.e. glLightfv(GL_LIGHT0, GL_POSITION, pos))
     float3 light_dir = normalize(light_position.xyz);
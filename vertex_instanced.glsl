@@ -0,0 +1,61 @@
+#version 450
+
+#ifdef COMPACT_VERTEX
+// CompactVertex in sdlgpu_render.h: HALF4 position (w = 1) + SHORT2_NORM octahedral normal
+layout(location = 0) in vec4 in_position;
+layout(location = 1) in vec2 in_normal_oct;
+
+vec3 oct_decode(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0)
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    return n; // normalized after the normal matrix anyway
+}
+#else
+layout(location = 0) in vec3 in_position;
+layout(location = 1) in vec3 in_normal;
+#endif
+
+// per-instance data (InstanceData in sdlgpu_render.h)
+layout(location = 2) in vec4 in_mvp_col0;
+layout(location = 3) in vec4 in_mvp_col1;
+layout(location = 4) in vec4 in_mvp_col2;
+layout(location = 5) in vec4 in_mvp_col3;
+layout(location = 6) in vec4 in_normal_col0;
+layout(location = 7) in vec4 in_normal_col1;
+layout(location = 8) in vec4 in_normal_col2;
+layout(location = 9) in vec4 in_color;
+
+layout(set = 1, binding = 0) uniform UniformBuffer {
+    vec3 light_position;
+    vec3 light_color;
+} ubo;
+
+layout(location = 0) out vec3 frag_color;
+
+void main() {
+#ifdef COMPACT_VERTEX
+    vec3 position = in_position.xyz;
+    vec3 normal = oct_decode(in_normal_oct);
+#else
+    vec3 position = in_position;
+    vec3 normal = in_normal;
+#endif
+
+    mat4 mvp_matrix = mat4(in_mvp_col0, in_mvp_col1, in_mvp_col2, in_mvp_col3);
+    mat3 normal_matrix = mat3(in_normal_col0.xyz, in_normal_col1.xyz, in_normal_col2.xyz);
+
+    gl_Position = mvp_matrix * vec4(position, 1.0);
+
+    // transform normal to view space for lighting calculation
+    vec3 view_normal = normalize(normal_matrix * normal);
+
+    // light direction in view space (i.e. glLightfv(GL_LIGHT0, GL_POSITION, pos))
+    vec3 light_dir = normalize(ubo.light_position);
+
+    float diff = max(dot(view_normal, light_dir), 0.0);
+    vec3 ambient = 0.2 * in_color.rgb;
+    vec3 diffuse = diff * ubo.light_color * in_color.rgb;
+
+    frag_color = ambient + diffuse;
+}
@@ -0,0 +1,74 @@
+struct VertexInput {
+#ifdef COMPACT_VERTEX
+    // CompactVertex in sdlgpu_render.h: HALF4 position (w = 1) + SHORT2_NORM octahedral normal
+    float4 position : TEXCOORD0;
+    float2 normal_oct : TEXCOORD1;
+#else
+    float3 position : TEXCOORD0;
+    float3 normal : TEXCOORD1;
+#endif
+    // per-instance data (InstanceData in sdlgpu_render.h)
+    float4 mvp_col0 : TEXCOORD2;
+    float4 mvp_col1 : TEXCOORD3;
+    float4 mvp_col2 : TEXCOORD4;
+    float4 mvp_col3 : TEXCOORD5;
+    float4 normal_col0 : TEXCOORD6;
+    float4 normal_col1 : TEXCOORD7;
+    float4 normal_col2 : TEXCOORD8;
+    float4 color : TEXCOORD9;
+};
+
+struct VertexOutput {
+    float3 color : TEXCOORD0;
+    float4 position : SV_POSITION;
+};
+
+cbuffer UniformBuffer : register(b0, space1) {
+    float4 light_position;  // vec3 padded to vec4
+    float4 light_color;     // vec3 padded to vec4
+};
+
+#ifdef COMPACT_VERTEX
+float3 oct_decode(float2 e) {
+    float3 n = float3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0)
+        n.xy = (1.0 - abs(n.yx)) * float2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    return n; // normalized after the normal matrix anyway
+}
+#endif
+
+VertexOutput main(VertexInput input) {
+    VertexOutput output;
+
+#ifdef COMPACT_VERTEX
+    float3 position = input.position.xyz;
+    float3 normal = oct_decode(input.normal_oct);
+#else
+    float3 position = input.position;
+    float3 normal = input.normal;
+#endif
+
+    // the columns become rows here, so multiply with the vector on the left
+    float4x4 mvp_matrix = float4x4(input.mvp_col0, input.mvp_col1, input.mvp_col2, input.mvp_col3);
+    output.position = mul(float4(position, 1.0), mvp_matrix);
+
+    float3x3 normal_matrix = float3x3(
+        input.normal_col0.xyz,
+        input.normal_col1.xyz,
+        input.normal_col2.xyz
+    );
+
+    // transform normal to view space for lighting calculation
+    float3 view_normal = normalize(mul(normal, normal_matrix));
+
+    // light direction in view space (i.e. glLightfv(GL_LIGHT0, GL_POSITION, pos))
+    float3 light_dir = normalize(light_position.xyz);
+
+    float diff = max(dot(view_normal, light_dir), 0.0);
+    float3 ambient = 0.2 * input.color.xyz;
+    float3 diffuse = diff * light_color.xyz * input.color.xyz;
+
+    output.color = ambient + diffuse;
+
+    return output;
+}
@@ -0,0 +1,125 @@
+#version 450
+
+// RENDER_PROCEDURAL: there's no vertex or index buffer, every vertex of the gear is rebuilt from gl_VertexIndex
+// this emits the same triangles in the same order as create_gears() in sdlgpu_gear_creation.c, before welding
+
+// per-instance data (InstanceData in sdlgpu_render.h)
+layout(location = 2) in vec4 in_mvp_col0;
+layout(location = 3) in vec4 in_mvp_col1;
+layout(location = 4) in vec4 in_mvp_col2;
+layout(location = 5) in vec4 in_mvp_col3;
+layout(location = 6) in vec4 in_normal_col0;
+layout(location = 7) in vec4 in_normal_col1;
+layout(location = 8) in vec4 in_normal_col2;
+layout(location = 9) in vec4 in_color;
+
+layout(set = 1, binding = 0) uniform UniformBuffer {
+    vec3 light_position;
+    vec3 light_color;
+    vec4 shape; // GearParams: inner_radius, outer_radius, width, tooth_depth
+    uint teeth;
+} ubo;
+
+layout(location = 0) out vec3 frag_color;
+
+const float PI = 3.14159265358979323846;
+
+// which of a quad's 4 vertices each corner of its 2 triangles uses (quad strips go v0 v1 v2 v3, teeth go around t0 t1 t2 t3)
+const uint strip_front[6] = uint[](0u, 1u, 3u, 0u, 3u, 2u);
+const uint strip_back[6] = uint[](0u, 3u, 1u, 0u, 2u, 3u);
+const uint tooth_front[6] = uint[](0u, 1u, 2u, 0u, 2u, 3u);
+const uint tooth_back[6] = uint[](0u, 2u, 1u, 0u, 3u, 2u);
+
+vec2 polar(float r, float angle) {
+    return r * vec2(cos(angle), sin(angle));
+}
+
+// outward normal of the tooth side from a to b (counterclockwise around the gear)
+vec3 side_normal(vec2 a, vec2 b) {
+    vec2 edge = b - a;
+    return vec3(normalize(vec2(edge.y, -edge.x)), 0.0);
+}
+
+void main() {
+    uint t = ubo.teeth;
+    float r0 = ubo.shape.x;
+    float r1 = ubo.shape.y - ubo.shape.w * 0.5;
+    float r2 = ubo.shape.y + ubo.shape.w * 0.5;
+    float half_width = ubo.shape.z * 0.5;
+    float tooth_angle = 2.0 * PI / float(t);
+    float da = tooth_angle / 4.0;
+
+    uint tri = uint(gl_VertexIndex) / 3u;
+    uint corner = (tri & 1u) * 3u + uint(gl_VertexIndex) % 3u; // every section is made of quads, i.e. triangle pairs
+
+    vec3 position;
+    vec3 normal;
+
+    // sections, in triangles: front ring 4t, front teeth 2t, back ring 4t, back teeth 2t, outer strip 8t, inner cylinder 2t
+    if (tri < 12u * t) {
+        bool back = tri >= 6u * t;
+        uint lt = back ? tri - 6u * t : tri;
+        float z = back ? -half_width : half_width;
+        normal = vec3(0.0, 0.0, back ? -1.0 : 1.0);
+
+        if (lt < 4u * t) {
+            // ring strip, 4 vertices per tooth: r0, r1, r0, r1 at +3da
+            uint k = (lt & ~1u) + (back ? strip_back[corner] : strip_front[corner]);
+            uint j = k % 4u;
+            float angle = float(k / 4u) * tooth_angle + (j == 3u ? 3.0 * da : 0.0);
+            position = vec3(polar((j & 1u) != 0u ? r1 : r0, angle), z);
+        } else {
+            // tooth top, r1 at +0da, r2 at +1da, r2 at +2da, r1 at +3da
+            lt -= 4u * t;
+            uint c = back ? tooth_back[corner] : tooth_front[corner];
+            float angle = float(lt / 2u) * tooth_angle + float(c) * da;
+            position = vec3(polar((c == 1u || c == 2u) ? r2 : r1, angle), z);
+        }
+    } else if (tri < 20u * t) {
+        // outer strip, 8 vertices per tooth: front/back pairs at +0da, +1da, +2da, +3da, then the closing pair at angle 0
+        uint s = ((tri - 12u * t) & ~1u) + strip_front[corner];
+        uint p = (s % 8u) / 2u;
+        float angle = float((s / 8u) % t) * tooth_angle;
+        float z = (s & 1u) != 0u ? -half_width : half_width;
+
+        vec2 radial = vec2(cos(angle), sin(angle));
+        if (p == 0u) {
+            position = vec3(r1 * radial, z);
+            normal = vec3(radial, 0.0);
+        } else if (p == 1u) {
+            position = vec3(polar(r2, angle + da), z);
+            normal = side_normal(r1 * radial, position.xy);
+        } else if (p == 2u) {
+            position = vec3(polar(r2, angle + 2.0 * da), z);
+            normal = vec3(radial, 0.0);
+        } else {
+            position = vec3(polar(r1, angle + 3.0 * da), z);
+            normal = side_normal(polar(r2, angle + 2.0 * da), position.xy);
+        }
+    } else {
+        // inner cylinder, one quad per tooth: back, front at this angle, front, back at the next
+        uint lt = tri - 20u * t;
+        uint c = tooth_front[corner];
+        float angle = float(lt / 2u + (c >= 2u ? 1u : 0u)) * tooth_angle;
+        vec2 radial = vec2(cos(angle), sin(angle));
+        position = vec3(r0 * radial, (c == 1u || c == 2u) ? half_width : -half_width);
+        normal = vec3(-radial, 0.0);
+    }
+
+    mat4 mvp_matrix = mat4(in_mvp_col0, in_mvp_col1, in_mvp_col2, in_mvp_col3);
+    mat3 normal_matrix = mat3(in_normal_col0.xyz, in_normal_col1.xyz, in_normal_col2.xyz);
+
+    gl_Position = mvp_matrix * vec4(position, 1.0);
+
+    // transform normal to view space for lighting calculation
+    vec3 view_normal = normalize(normal_matrix * normal);
+
+    // light direction in view space (i.e. glLightfv(GL_LIGHT0, GL_POSITION, pos))
+    vec3 light_dir = normalize(ubo.light_position);
+
+    float diff = max(dot(view_normal, light_dir), 0.0);
+    vec3 ambient = 0.2 * in_color.rgb;
+    vec3 diffuse = diff * ubo.light_color * in_color.rgb;
+
+    frag_color = ambient + diffuse;
+}
@@ -0,0 +1,138 @@
+// RENDER_PROCEDURAL: there's no vertex or index buffer, every vertex of the gear is rebuilt from SV_VertexID
+// this emits the same triangles in the same order as create_gears() in sdlgpu_gear_creation.c, before welding
+
+struct VertexInput {
+    uint vertex_id : SV_VertexID;
+    // per-instance data (InstanceData in sdlgpu_render.h)
+    float4 mvp_col0 : TEXCOORD2;
+    float4 mvp_col1 : TEXCOORD3;
+    float4 mvp_col2 : TEXCOORD4;
+    float4 mvp_col3 : TEXCOORD5;
+    float4 normal_col0 : TEXCOORD6;
+    float4 normal_col1 : TEXCOORD7;
+    float4 normal_col2 : TEXCOORD8;
+    float4 color : TEXCOORD9;
+};
+
+struct VertexOutput {
+    float3 color : TEXCOORD0;
+    float4 position : SV_POSITION;
+};
+
+cbuffer UniformBuffer : register(b0, space1) {
+    float4 light_position;  // vec3 padded to vec4
+    float4 light_color;     // vec3 padded to vec4
+    float4 shape;           // GearParams: inner_radius, outer_radius, width, tooth_depth
+    uint teeth;
+};
+
+static const float PI = 3.14159265358979323846;
+
+// which of a quad's 4 vertices each corner of its 2 triangles uses (quad strips go v0 v1 v2 v3, teeth go around t0 t1 t2 t3)
+static const uint strip_front[6] = {0, 1, 3, 0, 3, 2};
+static const uint strip_back[6] = {0, 3, 1, 0, 2, 3};
+static const uint tooth_front[6] = {0, 1, 2, 0, 2, 3};
+static const uint tooth_back[6] = {0, 2, 1, 0, 3, 2};
+
+float2 polar(float r, float angle) {
+    return r * float2(cos(angle), sin(angle));
+}
+
+// outward normal of the tooth side from a to b (counterclockwise around the gear)
+float3 side_normal(float2 a, float2 b) {
+    float2 edge = b - a;
+    return float3(normalize(float2(edge.y, -edge.x)), 0.0);
+}
+
+VertexOutput main(VertexInput input) {
+    VertexOutput output;
+
+    uint t = teeth;
+    float r0 = shape.x;
+    float r1 = shape.y - shape.w * 0.5;
+    float r2 = shape.y + shape.w * 0.5;
+    float half_width = shape.z * 0.5;
+    float tooth_angle = 2.0 * PI / float(t);
+    float da = tooth_angle / 4.0;
+
+    uint tri = input.vertex_id / 3;
+    uint corner = (tri & 1) * 3 + input.vertex_id % 3; // every section is made of quads, i.e. triangle pairs
+
+    float3 position;
+    float3 normal;
+
+    // sections, in triangles: front ring 4t, front teeth 2t, back ring 4t, back teeth 2t, outer strip 8t, inner cylinder 2t
+    if (tri < 12 * t) {
+        bool back = tri >= 6 * t;
+        uint lt = back ? tri - 6 * t : tri;
+        float z = back ? -half_width : half_width;
+        normal = float3(0.0, 0.0, back ? -1.0 : 1.0);
+
+        if (lt < 4 * t) {
+            // ring strip, 4 vertices per tooth: r0, r1, r0, r1 at +3da
+            uint k = (lt & ~1u) + (back ? strip_back[corner] : strip_front[corner]);
+            uint j = k % 4;
+            float angle = float(k / 4) * tooth_angle + (j == 3 ? 3.0 * da : 0.0);
+            position = float3(polar((j & 1) != 0 ? r1 : r0, angle), z);
+        } else {
+            // tooth top, r1 at +0da, r2 at +1da, r2 at +2da, r1 at +3da
+            lt -= 4 * t;
+            uint c = back ? tooth_back[corner] : tooth_front[corner];
+            float angle = float(lt / 2) * tooth_angle + float(c) * da;
+            position = float3(polar((c == 1 || c == 2) ? r2 : r1, angle), z);
+        }
+    } else if (tri < 20 * t) {
+        // outer strip, 8 vertices per tooth: front/back pairs at +0da, +1da, +2da, +3da, then the closing pair at angle 0
+        uint s = ((tri - 12 * t) & ~1u) + strip_front[corner];
+        uint p = (s % 8) / 2;
+        float angle = float((s / 8) % t) * tooth_angle;
+        float z = (s & 1) != 0 ? -half_width : half_width;
+
+        float2 radial = float2(cos(angle), sin(angle));
+        if (p == 0) {
+            position = float3(r1 * radial, z);
+            normal = float3(radial, 0.0);
+        } else if (p == 1) {
+            position = float3(polar(r2, angle + da), z);
+            normal = side_normal(r1 * radial, position.xy);
+        } else if (p == 2) {
+            position = float3(polar(r2, angle + 2.0 * da), z);
+            normal = float3(radial, 0.0);
+        } else {
+            position = float3(polar(r1, angle + 3.0 * da), z);
+            normal = side_normal(polar(r2, angle + 2.0 * da), position.xy);
+        }
+    } else {
+        // inner cylinder, one quad per tooth: back, front at this angle, front, back at the next
+        uint lt = tri - 20 * t;
+        uint c = tooth_front[corner];
+        float angle = float(lt / 2 + (c >= 2 ? 1 : 0)) * tooth_angle;
+        float2 radial = float2(cos(angle), sin(angle));
+        position = float3(r0 * radial, (c == 1 || c == 2) ? half_width : -half_width);
+        normal = float3(-radial, 0.0);
+    }
+
+    // the columns become rows here, so multiply with the vector on the left
+    float4x4 mvp_matrix = float4x4(input.mvp_col0, input.mvp_col1, input.mvp_col2, input.mvp_col3);
+    output.position = mul(float4(position, 1.0), mvp_matrix);
+
+    float3x3 normal_matrix = float3x3(
+        input.normal_col0.xyz,
+        input.normal_col1.xyz,
+        input.normal_col2.xyz
+    );
+
+    // transform normal to view space for lighting calculation
+    float3 view_normal = normalize(mul(normal, normal_matrix));
+
+    // light direction in view space (i.e. glLightfv(GL_LIGHT0, GL_POSITION, pos))
+    float3 light_dir = normalize(light_position.xyz);
+
+    float diff = max(dot(view_normal, light_dir), 0.0);
+    float3 ambient = 0.2 * input.color.xyz;
+    float3 diffuse = diff * light_color.xyz * input.color.xyz;
+
+    output.color = ambient + diffuse;
+
+    return output;
+}